@@ -17,7 +17,25 @@ SOURCES += \
     notificationwidget.cpp \
     configmanager.cpp \
     logger.cpp \
-    systemtraymanager.cpp
+    systemtraymanager.cpp \
+    doorevent.cpp \
+    eventcoalescer.cpp \
+    notificationmanager.cpp \
+    soundbank.cpp \
+    topicrouter.cpp \
+    reconnectpolicy.cpp \
+    duplicatefilter.cpp \
+    headlessnotifier.cpp \
+    processinfo.cpp \
+    terminationsignals.cpp \
+    latencyhistogram.cpp \
+    latencymonitor.cpp \
+    metricsserver.cpp \
+    eventhistory.cpp \
+    capturefile.cpp \
+    notificationscheduler.cpp \
+    inboundbuffer.cpp \
+    doorstatetable.cpp
 
 HEADERS += \
     clientmanager.h \
@@ -25,7 +43,30 @@ HEADERS += \
     notificationwidget.h \
     configmanager.h \
     logger.h \
-    systemtraymanager.h
+    systemtraymanager.h \
+    doorevent.h \
+    eventcoalescer.h \
+    notificationmanager.h \
+    soundbank.h \
+    topicrouter.h \
+    reconnectpolicy.h \
+    duplicatefilter.h \
+    headlessnotifier.h \
+    processinfo.h \
+    terminationsignals.h \
+    latencyhistogram.h \
+    latencymonitor.h \
+    metricsserver.h \
+    eventhistory.h \
+    capturefile.h \
+    notificationscheduler.h \
+    inboundbuffer.h \
+    doorstatetable.h
+
+# 编译期移除 DEBUG 日志：qmake CONFIG+=no_debug_log
+no_debug_log {
+    DEFINES += DOORSTATE_NO_DEBUG_LOG
+}
 
 # 资源文件
 RESOURCES += resources.qrc
@@ -36,6 +77,9 @@ win32 {
     CONFIG -= console
     CONFIG += windows
     
+    # ProcessInfo 读取进程内存占用
+    LIBS += -lpsapi
+    
     # 设置Windows程序图标（可选）
     RC_ICONS = app_icon.ico
     
@@ -43,6 +87,14 @@ win32 {
     # CONFIG += console
 }
 
+# GUI 子系统的程序从控制台启动时不连接控制台，--headless 配合 sink=stdout 在控制台中看不到输出
+# （重定向到文件或管道不受影响）。作为控制台服务运行时用 qmake CONFIG+=headless_console 构建，
+# 同时也能收到 Ctrl+C / 关闭窗口事件并正常退出
+win32:headless_console {
+    CONFIG -= windows
+    CONFIG += console
+}
+
 # Default rules for deployment.
 qnx: target.path = /tmp/$${TARGET}/bin
 else: unix:!android: target.path = /opt/$${TARGET}/bin
@@ -0,0 +1,241 @@
+#include "capturefile.h"
+#include "logger.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QtEndian>
+#include <cstring>
+
+namespace {
+
+const char CaptureMagic[4] = { 'D', 'S', 'C', 'P' };
+const quint8 CaptureVersion = 1;
+const int HeaderSize = 13;
+const int FlushBytes = 64 * 1024;
+const int FlushIntervalMs = 1000;
+
+} // namespace
+
+CaptureWriter::CaptureWriter()
+    : m_lastUs(0)
+    , m_recordCount(0)
+{
+}
+
+CaptureWriter::~CaptureWriter()
+{
+    close();
+}
+
+bool CaptureWriter::open(const QString &path)
+{
+    close();
+    
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        LOG_ERROR_CAT(Logger::Mqtt, QString("无法创建抓包文件: %1 (%2)").arg(path).arg(m_file.errorString()));
+        return false;
+    }
+    
+    char header[HeaderSize];
+    std::memcpy(header, CaptureMagic, sizeof(CaptureMagic));
+    header[4] = char(CaptureVersion);
+    qToLittleEndian<qint64>(QDateTime::currentMSecsSinceEpoch(), header + 5);
+    m_file.write(header, HeaderSize);
+    
+    m_topics.clear();
+    m_buffer.clear();
+    m_clock.start();
+    m_flushTimer.start();
+    m_lastUs = 0;
+    m_recordCount = 0;
+    LOG_INFO_CAT(Logger::Mqtt, QString("开始抓包: %1").arg(path));
+    return true;
+}
+
+void CaptureWriter::close()
+{
+    if (!m_file.isOpen()) {
+        return;
+    }
+    flushBuffer();
+    m_file.close();
+    LOG_INFO_CAT(Logger::Mqtt, QString("抓包结束: %1，共 %2 条消息").arg(m_file.fileName()).arg(m_recordCount));
+}
+
+bool CaptureWriter::isOpen() const
+{
+    return m_file.isOpen();
+}
+
+QString CaptureWriter::fileName() const
+{
+    return m_file.fileName();
+}
+
+void CaptureWriter::write(const QString &topic, const QByteArray &payload)
+{
+    if (!m_file.isOpen()) {
+        return;
+    }
+    
+    qint64 nowUs = m_clock.nsecsElapsed() / 1000;
+    appendVarint(quint64(qMax<qint64>(0, nowUs - m_lastUs)));
+    m_lastUs = nowUs;
+    
+    auto it = m_topics.constFind(topic);
+    if (it != m_topics.constEnd()) {
+        appendVarint(it.value());
+    } else {
+        quint32 topicId = quint32(m_topics.size());
+        m_topics.insert(topic, topicId);
+        QByteArray name = topic.toUtf8();
+        appendVarint(topicId);
+        appendVarint(quint64(name.size()));
+        m_buffer.append(name);
+    }
+    
+    appendVarint(quint64(payload.size()));
+    m_buffer.append(payload);
+    ++m_recordCount;
+    
+    if (m_buffer.size() >= FlushBytes || m_flushTimer.elapsed() >= FlushIntervalMs) {
+        flushBuffer();
+    }
+}
+
+void CaptureWriter::flushIfDue()
+{
+    if (m_file.isOpen() && !m_buffer.isEmpty() && m_flushTimer.elapsed() >= FlushIntervalMs) {
+        flushBuffer();
+    }
+}
+
+quint64 CaptureWriter::recordCount() const
+{
+    return m_recordCount;
+}
+
+void CaptureWriter::appendVarint(quint64 value)
+{
+    // 每字节 7 位，最高位表示后面还有字节
+    while (value >= 0x80) {
+        m_buffer.append(char((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    m_buffer.append(char(value));
+}
+
+void CaptureWriter::flushBuffer()
+{
+    if (!m_buffer.isEmpty()) {
+        m_file.write(m_buffer);
+        m_buffer.clear();
+    }
+    m_file.flush();
+    m_flushTimer.restart();
+}
+
+CaptureReader::CaptureReader()
+    : m_position(0)
+    , m_startedAtMs(0)
+    , m_offsetUs(0)
+{
+}
+
+bool CaptureReader::open(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        m_error = QString("无法打开抓包文件: %1 (%2)").arg(path).arg(file.errorString());
+        return false;
+    }
+    m_data = file.readAll();
+    
+    if (m_data.size() < HeaderSize || std::memcmp(m_data.constData(), CaptureMagic, sizeof(CaptureMagic)) != 0) {
+        m_error = QString("不是抓包文件: %1").arg(path);
+        return false;
+    }
+    if (quint8(m_data.at(4)) != CaptureVersion) {
+        m_error = QString("不支持的抓包文件版本: %1").arg(quint8(m_data.at(4)));
+        return false;
+    }
+    
+    m_startedAtMs = qFromLittleEndian<qint64>(m_data.constData() + 5);
+    m_position = HeaderSize;
+    m_topics.clear();
+    m_offsetUs = 0;
+    m_error.clear();
+    return true;
+}
+
+bool CaptureReader::next(CaptureRecord *record)
+{
+    if (m_position >= m_data.size()) {
+        return false;
+    }
+    
+    quint64 deltaUs = 0;
+    quint64 topicId = 0;
+    if (!readVarint(&deltaUs) || !readVarint(&topicId)) {
+        return false;
+    }
+    
+    if (topicId == quint64(m_topics.size())) {
+        quint64 length = 0;
+        if (!readVarint(&length) || length > quint64(m_data.size() - m_position)) {
+            m_error = "抓包文件在主题处截断";
+            return false;
+        }
+        m_topics.append(QString::fromUtf8(m_data.constData() + m_position, int(length)));
+        m_position += int(length);
+    } else if (topicId > quint64(m_topics.size())) {
+        m_error = QString("抓包文件损坏：无效的主题编号 %1").arg(topicId);
+        return false;
+    }
+    
+    quint64 payloadSize = 0;
+    if (!readVarint(&payloadSize) || payloadSize > quint64(m_data.size() - m_position)) {
+        // 程序异常退出时最后一条可能只写了一半
+        m_error = "抓包文件在负载处截断";
+        return false;
+    }
+    
+    m_offsetUs += qint64(deltaUs);
+    record->offsetUs = m_offsetUs;
+    record->receivedAtMs = m_startedAtMs + m_offsetUs / 1000;
+    record->topic = m_topics.at(int(topicId));
+    record->payload = m_data.mid(m_position, int(payloadSize));
+    m_position += int(payloadSize);
+    return true;
+}
+
+qint64 CaptureReader::startedAtMs() const
+{
+    return m_startedAtMs;
+}
+
+QString CaptureReader::errorString() const
+{
+    return m_error;
+}
+
+bool CaptureReader::readVarint(quint64 *value)
+{
+    quint64 result = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (m_position >= m_data.size()) {
+            m_error = "抓包文件意外结束";
+            return false;
+        }
+        quint8 byte = quint8(m_data.at(m_position++));
+        result |= quint64(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    m_error = "抓包文件损坏：变长整数过长";
+    return false;
+}
@@ -0,0 +1,77 @@
+#ifndef CAPTUREFILE_H
+#define CAPTUREFILE_H
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QHash>
+#include <QFile>
+#include <QElapsedTimer>
+
+// 抓包文件：记录收到的 MQTT 消息（主题、负载、接收时间），用于离线回放（doorbench --mode replay）
+// 文件头为 "DSCP" + 1 字节版本 + 8 字节开始时间（毫秒时间戳，小端），之后每条消息为
+//   变长整数 距上一条的微秒数 | 变长整数 主题编号 | [新主题: 变长整数 长度 + UTF-8] | 变长整数 负载长度 | 负载
+// 主题第一次出现时分配编号并写出全文，之后只写编号
+struct CaptureRecord
+{
+    qint64 offsetUs;      // 距抓包开始的微秒数
+    qint64 receivedAtMs;  // 收到消息时的本机时间（毫秒时间戳）
+    QString topic;
+    QByteArray payload;
+};
+
+class CaptureWriter
+{
+public:
+    CaptureWriter();
+    ~CaptureWriter();
+    
+    bool open(const QString &path);
+    void close();
+    bool isOpen() const;
+    QString fileName() const;
+    
+    // 写入缓冲区，缓冲超过 64 KB 或距上次写盘超过 1 秒时写入文件
+    void write(const QString &topic, const QByteArray &payload);
+    // 距上次写盘超过 1 秒且缓冲区非空时写入文件；
+    // ClientManager 每 500 毫秒调用一次，突发之后没有新消息时缓冲的数据最迟约 1.5 秒落盘
+    void flushIfDue();
+    quint64 recordCount() const;
+
+private:
+    void appendVarint(quint64 value);
+    void flushBuffer();
+    
+    QFile m_file;
+    QByteArray m_buffer;
+    QHash<QString, quint32> m_topics;
+    QElapsedTimer m_clock;       // 抓包开始后的单调时钟
+    qint64 m_lastUs;
+    QElapsedTimer m_flushTimer;
+    quint64 m_recordCount;
+};
+
+class CaptureReader
+{
+public:
+    CaptureReader();
+    
+    // 整个文件读入内存后顺序解析
+    bool open(const QString &path);
+    bool next(CaptureRecord *record);
+    
+    qint64 startedAtMs() const;
+    QString errorString() const;
+
+private:
+    bool readVarint(quint64 *value);
+    
+    QByteArray m_data;
+    int m_position;
+    QStringList m_topics;
+    qint64 m_startedAtMs;
+    qint64 m_offsetUs;
+    QString m_error;
+};
+
+#endif // CAPTUREFILE_H
@@ -1,32 +1,55 @@
 #include "clientmanager.h"
 #include "configmanager.h"
 #include "logger.h"
-#include <QApplication>
-#include <QScreen>
+#include "metricsserver.h"
+#include "capturefile.h"
+#include "notificationscheduler.h"
 #include <QDateTime>
-#include <QUrl>
-#include <QFileInfo>
+#include <QDir>
+#include <QThread>
+#include <QTimer>
+#include <QElapsedTimer>
 
-ClientManager::ClientManager(QObject *parent)
+ClientManager::ClientManager(bool headless, QObject *parent)
     : QObject(parent)
+    , headless(headless)
     , mqttClient(nullptr)
-    , notification(nullptr)
-    , soundEffect(nullptr)
+    , notifications(nullptr)
+    , soundBank(nullptr)
+    , scheduler(nullptr)
+    , headlessNotifier(nullptr)
+    , metricsServer(nullptr)
+    , coalescer(nullptr)
+    , networkThread(nullptr)
+    , captureWriter(new CaptureWriter())
+    , captureFlushTimer(nullptr)
 {
-    mqttClient = new MqttClient(this);
-    notification = new NotificationWidget();
-    soundEffect = new QSoundEffect(this);
+    // DoorEvent 需要跨线程排队传递
+    qRegisterMetaType<DoorEvent>("DoorEvent");
     
-    // 连接通知窗口关闭信号
-    connect(notification, &NotificationWidget::notificationClosed, this, [this]() {
-        // 通知关闭时停止音频
-        if (soundEffect && soundEffect->isPlaying()) {
-            soundEffect->stop();
-            LOG_INFO("通知关闭，停止音频播放");
-        }
+    // MQTT 网络、消息解析和事件合并运行在独立线程，界面线程只负责显示通知，
+    // 弹窗动画和模态对话框不会拖慢心跳和消息接收
+    networkThread = new QThread(this);
+    networkThread->setObjectName("DoorStateNetwork");
+    mqttClient = new MqttClient();
+    coalescer = new EventCoalescer();
+    // 抓包缓冲按时间写盘不能只靠下一条消息触发，消息停止后也要把缓冲的数据写出
+    captureFlushTimer = new QTimer(mqttClient);
+    captureFlushTimer->setInterval(500);
+    connect(captureFlushTimer, &QTimer::timeout, mqttClient, [this]() {
+        captureWriter->flushIfDue();
     });
+    mqttClient->moveToThread(networkThread);
+    coalescer->moveToThread(networkThread);
+    networkThread->start();
+    
+    metricsServer = new MetricsServer(this, this);
+    
+    if (headless) {
+        headlessNotifier = new HeadlessNotifier(this);
+    }
     
-    // 使用 lambda 表达式确保信号槽连接安全
+    // 使用 lambda 表达式确保信号槽连接安全；接收者在界面线程，信号自动排队
     connect(mqttClient, &MqttClient::connected, this, [this]() {
         onMqttConnected();
     });
@@ -39,85 +62,320 @@ ClientManager::ClientManager(QObject *parent)
     connect(mqttClient, &MqttClient::reconnecting, this, [this](int attemptCount) {
         onMqttReconnecting(attemptCount);
     });
-    connect(mqttClient, &MqttClient::doorEventReceived, this, [this](const QJsonObject &eventData) {
-        onDoorEvent(eventData);
+    connect(mqttClient, &MqttClient::overloadChanged, this, [this](bool overloaded, int queuedMessages) {
+        onMqttOverloadChanged(overloaded, queuedMessages);
+    });
+    connect(mqttClient, &MqttClient::doorStateSynced, this, [this](const DoorEvent &event) {
+        onDoorStateSynced(event);
+    });
+    // 门状态和事件历史在合并之前更新：被合并掉的松开事件和突发中的事件同样改变门的状态，也要能查到
+    connect(mqttClient, &MqttClient::doorEventReceived, this, [this](const DoorEvent &event) {
+        updateDoorState(event, true);
+        eventHistory.append(event);
+    });
+    
+    // 按当前配置快照初始化各组件，配置变化时重新应用
+    applyConfig(ConfigManager::instance()->snapshot());
+    connect(ConfigManager::instance(), &ConfigManager::configChanged, this, [this]() {
+        applyConfig(ConfigManager::instance()->snapshot());
+    });
+    
+    // lazy 策略下通知窗口和提示音在连接成功后的空闲时间或第一次显示通知时创建
+    if (!headless && currentConfig->startupStrategy != "lazy") {
+        createUiComponents(true);
+    }
+    
+    // 抓包：上下文对象是 mqttClient，在网络线程中直接写入
+    connect(mqttClient, &MqttClient::messageReceived, mqttClient, [this](const QString &topic, const QByteArray &payload) {
+        if (captureWriter->isOpen()) {
+            captureWriter->write(topic, payload);
+        }
+    });
+    
+    // 门禁事件先经过合并阶段（网络线程内直接调用），再排队到界面线程进入通知/音频处理
+    connect(mqttClient, &MqttClient::doorEventReceived, coalescer, &EventCoalescer::addEvent);
+    connect(coalescer, &EventCoalescer::eventReady, this, [this](const DoorEvent &event) {
+        onDoorEvent(event);
+    });
+    connect(coalescer, &EventCoalescer::digestReady, this, [this](int eventCount, int doorCount, int windowMs) {
+        onEventDigest(eventCount, doorCount, windowMs);
     });
 }
 
 ClientManager::~ClientManager()
 {
     stop();
-    if (notification) {
-        delete notification;
-        notification = nullptr;
+    networkThread->quit();
+    networkThread->wait();
+    // 线程已结束，可以在这里直接删除其中的对象
+    delete coalescer;
+    delete mqttClient;
+    delete captureWriter;
+    
+    if (notifications) {
+        notifications->closeAll();
+    }
+    if (soundBank) {
+        soundBank->stop();
+    }
+}
+
+void ClientManager::applyConfig(const ConfigSnapshotPtr &config)
+{
+    if (headless) {
+        headlessNotifier->setTarget(HeadlessNotifier::targetFromString(config->headlessSink),
+                                    config->headlessSocketName);
+    } else if (notifications) {
+        applyUiConfig(config, currentConfig);
+    }
+    
+    metricsServer->setEnabled(config->metricsEnabled, config->metricsPort);
+    
+    // 历史文件参数变化时重新打开；容量变化会重建文件
+    if (!config->historyEnabled) {
+        eventHistory.close();
+    } else if (!eventHistory.isOpen()
+               || currentConfig->historyPath != config->historyPath
+               || currentConfig->historyCapacity != config->historyCapacity
+               || currentConfig->historyHeapBytes != config->historyHeapBytes) {
+        eventHistory.open(config->historyPath, config->historyCapacity, config->historyHeapBytes);
+    }
+    
+    // 网络线程中的对象只能在该线程内修改
+    ConfigSnapshotPtr previous = currentConfig;
+    QMetaObject::invokeMethod(mqttClient, [this, config, previous]() {
+        applyNetworkConfig(config, previous);
+    });
+    
+    currentConfig = config;
+}
+
+void ClientManager::applyUiConfig(const ConfigSnapshotPtr &config, const ConfigSnapshotPtr &previous)
+{
+    // 预加载提示音，事件到达时直接播放；音频路径未变化时不重新加载
+    soundBank->setVolume(config->notificationSoundVolume);
+    soundBank->setLoopMode(config->notificationSoundLoop);
+    if (!previous
+            || previous->notificationSoundPath != config->notificationSoundPath
+            || previous->notificationSounds != config->notificationSounds) {
+        soundBank->load(config->notificationSoundPath, config->notificationSounds);
+    }
+    
+    notifications->setRenderer(NotificationWidget::rendererFromString(config->notificationRenderer));
+    notifications->setMaxVisible(config->notificationMaxVisible);
+    
+    scheduler->setQueueCapacity(config->schedulerQueueCapacity);
+    for (int priority = 0; priority < DoorEvent::PriorityCount; ++priority) {
+        scheduler->setDuration(DoorEvent::Priority(priority), config->priorityDurations.at(priority));
+        scheduler->setSoundLoop(DoorEvent::Priority(priority), config->prioritySoundLoops.at(priority) == "loop");
+    }
+}
+
+void ClientManager::createUiComponents(bool prewarm)
+{
+    if (headless || notifications) {
+        return;
+    }
+    
+    QElapsedTimer timer;
+    timer.start();
+    
+    notifications = new NotificationManager(currentConfig->notificationMaxVisible,
+                                            NotificationWidget::rendererFromString(currentConfig->notificationRenderer),
+                                            this);
+    soundBank = new SoundBank(this);
+    scheduler = new NotificationScheduler(notifications, soundBank, this);
+    scheduler->setLatencyMonitor(&latencyMonitor);
+    
+    // 连接通知关闭信号（堆叠中的通知全部关闭后触发）
+    connect(notifications, &NotificationManager::allNotificationsClosed, this, [this]() {
+        // 通知关闭时停止音频
+        if (soundBank && soundBank->isPlaying()) {
+            soundBank->stop();
+            LOG_INFO_CAT(Logger::Ui, "通知关闭，停止音频播放");
+        }
+    });
+    connect(soundBank, &SoundBank::playbackStarted, this, [this](qint64 latencyUs) {
+        latencyMonitor.recordSoundStart(latencyUs);
+    });
+    
+    applyUiConfig(currentConfig, ConfigSnapshotPtr());
+    if (prewarm) {
+        notifications->prewarm();
+    }
+    
+    LOG_INFO_CAT(Logger::Ui, QString("通知窗口和提示音已创建（%1），耗时 %2 ms")
+                 .arg(prewarm ? "预热" : "延迟创建")
+                 .arg(timer.elapsed()));
+}
+
+void ClientManager::applyNetworkConfig(const ConfigSnapshotPtr &config, const ConfigSnapshotPtr &previous)
+{
+    coalescer->setEnabled(config->coalesceEnabled);
+    coalescer->setPairWindow(config->coalescePairWindow);
+    coalescer->setBurstThreshold(config->coalesceBurstThreshold);
+    coalescer->setBurstWindow(config->coalesceBurstWindow);
+    coalescer->setEventPriorities(config->eventPriorities);
+    
+    if (!previous
+            || previous->mqttReconnectPolicy != config->mqttReconnectPolicy
+            || previous->mqttReconnectInterval != config->mqttReconnectInterval
+            || previous->mqttReconnectMin != config->mqttReconnectMin
+            || previous->mqttReconnectMax != config->mqttReconnectMax) {
+        mqttClient->setReconnectPolicy(ReconnectPolicy::create(config->mqttReconnectPolicy,
+                                                               config->mqttReconnectInterval,
+                                                               config->mqttReconnectMin,
+                                                               config->mqttReconnectMax));
+    }
+    
+    // 会话参数在下次连接时生效
+    mqttClient->setClientId(config->mqttClientId);
+    mqttClient->setCleanSession(config->mqttCleanSession);
+    mqttClient->setDuplicateCapacity(config->mqttDedupCapacity);
+    mqttClient->setDuplicateWindow(config->mqttDedupWindow);
+    mqttClient->setInboundLimits(config->inboundCapacity, config->inboundHighWatermark, config->inboundLowWatermark);
+    mqttClient->setInboundPolicy(InboundBuffer::policyFromString(config->inboundPolicy), config->inboundSampleEvery);
+    mqttClient->setInboundRateLimit(config->inboundRateLimit);
+    mqttClient->setSyncWindow(config->syncEnabled, config->syncQuietMs, config->syncMaxMs);
+    
+    if (!config->captureEnabled) {
+        captureWriter->close();
+    } else if (!captureWriter->isOpen() || !previous || previous->captureDir != config->captureDir) {
+        QString fileName = QString("DoorCapture_%1.cap").arg(QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss"));
+        captureWriter->open(QDir(config->captureDir).filePath(fileName));
+    }
+    if (captureWriter->isOpen()) {
+        captureFlushTimer->start();
+    } else {
+        captureFlushTimer->stop();
+    }
+    
+    // 同步订阅注册表：MqttClient 按过滤器去重，连接后统一订阅
+    if (previous) {
+        for (auto it = previous->mqttSubscriptions.constBegin(); it != previous->mqttSubscriptions.constEnd(); ++it) {
+            if (!config->mqttSubscriptions.contains(it.key())) {
+                mqttClient->removeSubscription(it.key());
+            }
+        }
     }
-    if (soundEffect) {
-        soundEffect->stop();
-        delete soundEffect;
-        soundEffect = nullptr;
+    for (auto it = config->mqttSubscriptions.constBegin(); it != config->mqttSubscriptions.constEnd(); ++it) {
+        if (!previous || previous->mqttSubscriptions.value(it.key(), -1) != it.value()) {
+            mqttClient->addSubscription(it.key(), quint8(it.value()));
+        }
     }
 }
 
 void ClientManager::start()
 {
-    ConfigManager *config = ConfigManager::instance();
+    ConfigSnapshotPtr config = ConfigManager::instance()->snapshot();
     
     // 连接 MQTT 服务器
-    QString mqttHost = config->getMqttHost();
-    quint16 mqttPort = config->getMqttPort();
-    mqttClient->connectToHost(mqttHost, mqttPort);
+    QString mqttHost = config->mqttHost;
+    quint16 mqttPort = config->mqttPort;
+    QMetaObject::invokeMethod(mqttClient, [this, mqttHost, mqttPort]() {
+        mqttClient->connectToHost(mqttHost, mqttPort);
+    });
 }
 
 void ClientManager::stop()
 {
-    if (mqttClient) {
-        mqttClient->disconnectFromHost();
+    // 等待网络线程完成断开，退出时不会留下半关闭的连接
+    if (mqttClient && networkThread->isRunning()) {
+        QMetaObject::invokeMethod(mqttClient, [this]() {
+            mqttClient->disconnectFromHost();
+        }, Qt::BlockingQueuedConnection);
     }
 }
 
+MqttClient *ClientManager::mqtt() const
+{
+    return mqttClient;
+}
+
+const LatencyMonitor &ClientManager::latency() const
+{
+    return latencyMonitor;
+}
+
+const EventCoalescer *ClientManager::eventCoalescer() const
+{
+    return coalescer;
+}
+
+int ClientManager::notificationQueueDepth() const
+{
+    return notifications ? notifications->visibleCount() : 0;
+}
+
+int ClientManager::notificationBacklog() const
+{
+    return scheduler ? scheduler->queueDepth() : 0;
+}
+
+const DoorStateTable &ClientManager::doorStates() const
+{
+    return doorStateTable;
+}
+
+quint64 ClientManager::droppedNotificationCount() const
+{
+    return scheduler ? scheduler->droppedCount() : 0;
+}
+
+const EventHistory &ClientManager::history() const
+{
+    return eventHistory;
+}
+
 void ClientManager::onMqttConnected()
 {
-    LOG_INFO("MQTT 客户端连接成功");
+    // 订阅由 MqttClient 在连接后按注册表完成，这里不再重复订阅
+    LOG_INFO_CAT(Logger::Mqtt, "MQTT 客户端连接成功");
     
-    // 连接成功后订阅控制主题
-    ConfigManager *config = ConfigManager::instance();
-    QString subscribeTopic = config->getMqttSubscribeTopic();
-    mqttClient->subscribe(subscribeTopic);
+    // lazy 策略：连接已建立，在事件循环空闲时创建通知窗口和提示音
+    if (!headless && !notifications) {
+        QTimer::singleShot(0, this, [this]() {
+            createUiComponents(false);
+        });
+    }
 }
 
 void ClientManager::onMqttDisconnected()
 {
-    LOG_WARNING("MQTT 客户端断开连接");
+    LOG_WARNING_CAT(Logger::Mqtt, "MQTT 客户端断开连接");
 }
 
 void ClientManager::onMqttError(const QString &error)
 {
-    LOG_ERROR(QString("MQTT 连接错误: %1").arg(error));
+    LOG_ERROR_CAT(Logger::Mqtt, QString("MQTT 连接错误: %1").arg(error));
 }
 
 void ClientManager::onMqttReconnecting(int attemptCount)
 {
-    LOG_INFO(QString("MQTT 正在尝试第 %1 次重连...").arg(attemptCount));
+    LOG_INFO_CAT(Logger::Mqtt, QString("MQTT 正在尝试第 %1 次重连...").arg(attemptCount));
+}
+
+void ClientManager::onMqttOverloadChanged(bool overloaded, int queuedMessages)
+{
+    // 详细情况由 MqttClient 写入日志，这里只在进入过载时提示一次
+    if (!overloaded) {
+        return;
+    }
+    
+    QString title = QString("门禁消息过载 - %1").arg(QDateTime::currentDateTime().toString("HH:mm:ss"));
+    QString message = QString("积压 %1 条消息，部分门禁事件将被丢弃").arg(queuedMessages);
+    showNotification(title, message, "overload", DoorEvent::High);
 }
 
-void ClientManager::onDoorEvent(const QJsonObject &eventData)
+void ClientManager::onDoorEvent(const DoorEvent &event)
 {
-    LOG_INFO("收到门禁事件");
+    LOG_EVENT_CAT(Logger::Info, Logger::General, "收到门禁事件", event.doorId, event.event);
     
-    // 获取时间戳 - 优先使用服务端发送的 timestamp，没有则使用客户端当前时间
+    // 获取时间戳 - 优先使用服务端发送的 timestamp，没有或解析失败则使用客户端当前时间
     QString timeStr;
-    if (eventData.contains("timestamp")) {
-        // 解析服务端的 ISO 格式时间戳
-        QString timestamp = eventData["timestamp"].toString();
-        QDateTime dateTime = QDateTime::fromString(timestamp, Qt::ISODate);
-        if (dateTime.isValid()) {
-            timeStr = dateTime.toString("HH:mm:ss");
-        } else {
-            // 如果解析失败，使用客户端当前时间
-            timeStr = QDateTime::currentDateTime().toString("HH:mm:ss");
-        }
+    if (event.dateTime.isValid()) {
+        timeStr = event.dateTime.toString("HH:mm:ss");
     } else {
-        // 没有 timestamp 字段，使用客户端当前时间
         timeStr = QDateTime::currentDateTime().toString("HH:mm:ss");
     }
     
@@ -125,8 +383,8 @@ void ClientManager::onDoorEvent(const QJsonObject &eventData)
     QString message = "开门按钮已被按下!";
     
     // 检查是否有自定义的事件类型或消息
-    if (eventData.contains("event")) {
-        QString eventType = eventData["event"].toString();
+    if (event.hasEvent) {
+        const QString &eventType = event.event;
         if (eventType == "door_button_pressed") {
             message = "开门按钮已被按下!";
         } else if (eventType == "door_button_released") {
@@ -137,75 +395,53 @@ void ClientManager::onDoorEvent(const QJsonObject &eventData)
     }
     
     // 如果包含自定义消息
-    if (eventData.contains("message")) {
-        message = eventData["message"].toString();
+    if (event.hasMessage) {
+        message = event.message;
     }
     
-    // 从配置文件获取通知显示时长
-    ConfigManager *config = ConfigManager::instance();
-    int duration = config->getNotificationDuration();
-    
-    // 播放通知音频
-    QString soundPath = config->getNotificationSoundPath();
-    qreal soundVolume = config->getNotificationSoundVolume();
-    QString soundLoop = config->getNotificationSoundLoop();
-    
-    if (!soundPath.isEmpty()) {
-        playNotificationSound(soundPath, soundVolume, soundLoop);
-    }
-    
-    // 显示通知窗口在屏幕右下角
-    QScreen *screen = QApplication::primaryScreen();
-    if (screen) {
-        QRect screenGeometry = screen->availableGeometry();
-        
-        int x = screenGeometry.right() - notification->width() - 20;
-        int y = screenGeometry.bottom() - notification->height() - 20;
-        
-        notification->move(x, y);
-        notification->showNotification(title, message, duration);
-        
-        LOG_INFO(QString("显示通知: %1 - %2").arg(title).arg(message));
-    }
+    // 优先级已由合并阶段确定；延迟在通知真正显示时记录，排队中或被丢弃的通知不计入
+    showNotification(title, message, event.event, event.priority, event);
 }
 
-void ClientManager::playNotificationSound(const QString &soundPath, qreal volume, const QString &loopMode)
+void ClientManager::onDoorStateSynced(const DoorEvent &event)
 {
-    if (!soundEffect) {
-        LOG_WARNING("音频播放器未初始化");
-        return;
-    }
-    
-    // 停止之前的播放
-    if (soundEffect->isPlaying()) {
-        soundEffect->stop();
+    // 同步阶段更新门状态表并写入事件历史（断线期间补发的事件也要能查到），不弹窗，也不计入延迟统计
+    LOG_DEBUG_CAT(Logger::Mqtt, QString("同步门状态: %1 - %2").arg(event.doorId).arg(event.event));
+    updateDoorState(event, false);
+    eventHistory.append(event);
+}
+
+void ClientManager::updateDoorState(const DoorEvent &event, bool live)
+{
+    if (doorStateTable.update(event, live)) {
+        emit doorSummaryChanged();
     }
+}
+
+void ClientManager::onEventDigest(int eventCount, int doorCount, int windowMs)
+{
+    QString title = QString("门禁通知汇总 - %1").arg(QDateTime::currentDateTime().toString("HH:mm:ss"));
+    QString message = QString("%1 秒内收到 %2 个门禁事件，来自 %3 个门")
+            .arg(qMax(1, (windowMs + 500) / 1000))
+            .arg(eventCount)
+            .arg(doorCount);
     
-    // 检查文件是否存在
-    QFileInfo fileInfo(soundPath);
-    if (!fileInfo.exists()) {
-        LOG_WARNING(QString("音频文件不存在: %1").arg(soundPath));
+    DoorEvent::Priority priority = DoorEvent::Priority(currentConfig->eventPriorities.value("digest", DoorEvent::Normal));
+    showNotification(title, message, "digest", priority);
+}
+
+void ClientManager::showNotification(const QString &title, const QString &message, const QString &eventType,
+                                     DoorEvent::Priority priority, const DoorEvent &source)
+{
+    if (headless) {
+        headlessNotifier->notify(title, message, eventType);
+        latencyMonitor.recordEvent(source);
         return;
     }
     
-    // 确保音量在有效范围内
-    if (volume < 0.0) volume = 0.0;
-    if (volume > 1.0) volume = 1.0;
-    
-    // 设置音频源
-    QUrl soundUrl = QUrl::fromLocalFile(fileInfo.absoluteFilePath());
-    soundEffect->setSource(soundUrl);
-    soundEffect->setVolume(volume);
-    
-    // 设置循环次数
-    if (loopMode == "loop") {
-        soundEffect->setLoopCount(QSoundEffect::Infinite);  // 无限循环
-        LOG_INFO(QString("播放通知音频（循环模式）: %1 (音量: %2)").arg(soundPath).arg(volume));
-    } else {
-        soundEffect->setLoopCount(1);  // 播放一次
-        LOG_INFO(QString("播放通知音频（单次模式）: %1 (音量: %2)").arg(soundPath).arg(volume));
-    }
+    // lazy 策略下第一次显示通知时才创建窗口和提示音
+    createUiComponents(false);
     
-    // 播放音频
-    soundEffect->play();
+    // 由调度器按优先级决定显示时长、提示音模式，以及立即显示、替换还是排队
+    scheduler->submit(title, message, eventType, priority, source);
 }
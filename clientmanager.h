@@ -2,34 +2,85 @@
 #define CLIENTMANAGER_H
 
 #include <QObject>
-#include <QSoundEffect>
 #include "mqttclient.h"
-#include "notificationwidget.h"
+#include "notificationmanager.h"
+#include "eventcoalescer.h"
+#include "soundbank.h"
+#include "headlessnotifier.h"
+#include "latencymonitor.h"
+#include "eventhistory.h"
+#include "doorstatetable.h"
+
+class MetricsServer;
+class CaptureWriter;
+class NotificationScheduler;
+class QThread;
+#include "configmanager.h"
 
 class ClientManager : public QObject
 {
     Q_OBJECT
 
 public:
-    explicit ClientManager(QObject *parent = nullptr);
+    // headless 为 true 时不创建任何窗口和音频对象，通知交给 HeadlessNotifier 输出
+    explicit ClientManager(bool headless = false, QObject *parent = nullptr);
     ~ClientManager();
     
     void start();
     void stop();
+    
+    // 返回的对象运行在网络线程，其他线程只能调用统计和状态查询方法
+    MqttClient *mqtt() const;
+    const LatencyMonitor &latency() const;
+    const EventCoalescer *eventCoalescer() const;
+    int notificationQueueDepth() const;
+    // 屏幕已满时排队等待显示的通知数，以及队列满时丢弃的通知数
+    int notificationBacklog() const;
+    // 门状态表，实时事件（合并之前）和同步阶段的状态都会更新，只在界面线程读取
+    const DoorStateTable &doorStates() const;
+    quint64 droppedNotificationCount() const;
+    // 事件历史，记录合并之前的每个实时事件和同步阶段的事件，只在界面线程读写
+    const EventHistory &history() const;
+
+signals:
+    void doorSummaryChanged();  // 门数或某个状态的门数变化，见 DoorStateTable::summary()
 
 private slots:
     void onMqttConnected();
     void onMqttDisconnected();
     void onMqttError(const QString &error);
     void onMqttReconnecting(int attemptCount);
-    void onDoorEvent(const QJsonObject &eventData);
+    void onMqttOverloadChanged(bool overloaded, int queuedMessages);
+    void onDoorEvent(const DoorEvent &event);
+    void onDoorStateSynced(const DoorEvent &event);
+    void updateDoorState(const DoorEvent &event, bool live);
+    void onEventDigest(int eventCount, int doorCount, int windowMs);
 
 private:
-    void playNotificationSound(const QString &soundPath, qreal volume = 1.0, const QString &loopMode = "once");
+    void applyConfig(const ConfigSnapshotPtr &config);
+    void applyUiConfig(const ConfigSnapshotPtr &config, const ConfigSnapshotPtr &previous);
+    // 创建通知窗口池和提示音库；prewarm 为 true 时对窗口离屏绘制一次
+    void createUiComponents(bool prewarm);
+    void applyNetworkConfig(const ConfigSnapshotPtr &config, const ConfigSnapshotPtr &previous);
+    // source 为通知对应的事件，用于显示时记录延迟；汇总通知没有对应的事件
+    void showNotification(const QString &title, const QString &message, const QString &eventType,
+                          DoorEvent::Priority priority, const DoorEvent &source = DoorEvent());
     
+    bool headless;
     MqttClient *mqttClient;
-    NotificationWidget *notification;
-    QSoundEffect *soundEffect;
+    NotificationManager *notifications;
+    SoundBank *soundBank;
+    NotificationScheduler *scheduler;
+    HeadlessNotifier *headlessNotifier;
+    MetricsServer *metricsServer;
+    EventCoalescer *coalescer;
+    QThread *networkThread;  // mqttClient 和 coalescer 所在的线程
+    CaptureWriter *captureWriter;  // 只在网络线程中使用
+    QTimer *captureFlushTimer;     // mqttClient 的子对象，在网络线程中定时写盘
+    ConfigSnapshotPtr currentConfig;
+    LatencyMonitor latencyMonitor;
+    EventHistory eventHistory;
+    DoorStateTable doorStateTable;
 };
 
 #endif // CLIENTMANAGER_H
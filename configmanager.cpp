@@ -1,17 +1,28 @@
 #include "configmanager.h"
+#include "doorevent.h"
 #include <QCoreApplication>
 #include <QDir>
 #include <QFileInfo>
 #include <QDebug>
+#include <QMutex>
+#include <QSysInfo>
+#include <QCryptographicHash>
 
-ConfigManager* ConfigManager::m_instance = nullptr;
+QAtomicPointer<ConfigManager> ConfigManager::m_instance;
 
 ConfigManager* ConfigManager::instance(const QString &configPath)
 {
-    if (!m_instance) {
-        m_instance = new ConfigManager(configPath);
+    ConfigManager *manager = m_instance.loadAcquire();
+    if (!manager) {
+        static QMutex instanceMutex;
+        QMutexLocker locker(&instanceMutex);
+        manager = m_instance.loadAcquire();
+        if (!manager) {
+            manager = new ConfigManager(configPath);
+            m_instance.storeRelease(manager);
+        }
     }
-    return m_instance;
+    return manager;
 }
 
 ConfigManager::ConfigManager(const QString &configPath, QObject *parent)
@@ -50,6 +61,60 @@ void ConfigManager::loadConfig()
     if (!settings->contains("MQTT/subscribe_topic")) {
         settings->setValue("MQTT/subscribe_topic", "door-events");
     }
+    if (!settings->contains("MQTT/subscribe_qos")) {
+        settings->setValue("MQTT/subscribe_qos", 0);
+    }
+    if (!settings->contains("MQTT/reconnect_policy")) {
+        settings->setValue("MQTT/reconnect_policy", "exponential");
+    }
+    if (!settings->contains("MQTT/reconnect_interval_ms")) {
+        settings->setValue("MQTT/reconnect_interval_ms", 5000);
+    }
+    if (!settings->contains("MQTT/reconnect_min_ms")) {
+        settings->setValue("MQTT/reconnect_min_ms", 1000);
+    }
+    if (!settings->contains("MQTT/reconnect_max_ms")) {
+        settings->setValue("MQTT/reconnect_max_ms", 60000);
+    }
+    if (!settings->contains("MQTT/client_id")) {
+        settings->setValue("MQTT/client_id", "");
+    }
+    if (!settings->contains("MQTT/clean_session")) {
+        settings->setValue("MQTT/clean_session", true);
+    }
+    if (!settings->contains("MQTT/dedup_capacity")) {
+        settings->setValue("MQTT/dedup_capacity", 1024);
+    }
+    if (!settings->contains("MQTT/dedup_window_ms")) {
+        settings->setValue("MQTT/dedup_window_ms", 60000);
+    }
+    if (!settings->contains("Inbound/capacity")) {
+        settings->setValue("Inbound/capacity", 5000);
+    }
+    if (!settings->contains("Inbound/high_watermark")) {
+        settings->setValue("Inbound/high_watermark", 4000);
+    }
+    if (!settings->contains("Inbound/low_watermark")) {
+        settings->setValue("Inbound/low_watermark", 1000);
+    }
+    if (!settings->contains("Inbound/policy")) {
+        settings->setValue("Inbound/policy", "drop_oldest");
+    }
+    if (!settings->contains("Inbound/sample_every")) {
+        settings->setValue("Inbound/sample_every", 10);
+    }
+    if (!settings->contains("Inbound/rate_limit")) {
+        settings->setValue("Inbound/rate_limit", 500);
+    }
+    if (!settings->contains("Sync/enabled")) {
+        settings->setValue("Sync/enabled", true);
+    }
+    if (!settings->contains("Sync/quiet_ms")) {
+        settings->setValue("Sync/quiet_ms", 500);
+    }
+    if (!settings->contains("Sync/max_ms")) {
+        settings->setValue("Sync/max_ms", 5000);
+    }
     if (!settings->contains("Notification/duration")) {
         settings->setValue("Notification/duration", 3000);
     }
@@ -62,18 +127,218 @@ void ConfigManager::loadConfig()
     if (!settings->contains("Notification/sound_loop")) {
         settings->setValue("Notification/sound_loop", "loop");
     }
+    if (!settings->contains("Notification/max_visible")) {
+        settings->setValue("Notification/max_visible", 3);
+    }
+    if (!settings->contains("Notification/renderer")) {
+        settings->setValue("Notification/renderer", "stylesheet");
+    }
+    if (!settings->contains("Scheduler/queue_capacity")) {
+        settings->setValue("Scheduler/queue_capacity", 20);
+    }
+    // 各优先级的默认显示时长和提示音模式，0 和空值表示沿用 [Notification] 的设置
+    static const int defaultDurations[DoorEvent::PriorityCount] = { 2000, 0, 10000, 30000 };
+    static const char *const defaultLoops[DoorEvent::PriorityCount] = { "once", "", "loop", "loop" };
+    for (int priority = 0; priority < DoorEvent::PriorityCount; ++priority) {
+        QString name = DoorEvent::priorityName(DoorEvent::Priority(priority));
+        if (!settings->contains(QString("Scheduler/%1_duration").arg(name))) {
+            settings->setValue(QString("Scheduler/%1_duration").arg(name), defaultDurations[priority]);
+        }
+        if (!settings->contains(QString("Scheduler/%1_sound_loop").arg(name))) {
+            settings->setValue(QString("Scheduler/%1_sound_loop").arg(name), defaultLoops[priority]);
+        }
+    }
+    if (!settings->contains("Coalesce/enabled")) {
+        settings->setValue("Coalesce/enabled", true);
+    }
+    if (!settings->contains("Coalesce/pair_window_ms")) {
+        settings->setValue("Coalesce/pair_window_ms", 1000);
+    }
+    if (!settings->contains("Coalesce/burst_threshold")) {
+        settings->setValue("Coalesce/burst_threshold", 5);
+    }
+    if (!settings->contains("Coalesce/burst_window_ms")) {
+        settings->setValue("Coalesce/burst_window_ms", 5000);
+    }
+    if (!settings->contains("Headless/sink")) {
+        settings->setValue("Headless/sink", "log");
+    }
+    if (!settings->contains("Headless/socket_name")) {
+        settings->setValue("Headless/socket_name", "DoorStateClient");
+    }
+    if (!settings->contains("Metrics/enabled")) {
+        settings->setValue("Metrics/enabled", false);
+    }
+    if (!settings->contains("Metrics/port")) {
+        settings->setValue("Metrics/port", 9464);
+    }
+    if (!settings->contains("Capture/enabled")) {
+        settings->setValue("Capture/enabled", false);
+    }
+    if (!settings->contains("Capture/dir")) {
+        settings->setValue("Capture/dir", "./captures");
+    }
+    if (!settings->contains("Startup/strategy")) {
+        settings->setValue("Startup/strategy", "prewarm");
+    }
+    if (!settings->contains("History/enabled")) {
+        settings->setValue("History/enabled", true);
+    }
+    if (!settings->contains("History/path")) {
+        settings->setValue("History/path", "./history/events.ring");
+    }
+    if (!settings->contains("History/capacity")) {
+        settings->setValue("History/capacity", 10000);
+    }
+    if (!settings->contains("History/heap_bytes")) {
+        settings->setValue("History/heap_bytes", 1048576);
+    }
     if (!settings->contains("Log/path")) {
         settings->setValue("Log/path", "./logs");
     }
     if (!settings->contains("Log/retention_days")) {
         settings->setValue("Log/retention_days", 7);
     }
+    if (!settings->contains("Log/max_file_size")) {
+        settings->setValue("Log/max_file_size", 10485760);
+    }
+    if (!settings->contains("Log/max_files")) {
+        settings->setValue("Log/max_files", 50);
+    }
+    if (!settings->contains("Log/compress")) {
+        settings->setValue("Log/compress", true);
+    }
+    if (!settings->contains("Log/async")) {
+        settings->setValue("Log/async", true);
+    }
+    if (!settings->contains("Log/flush_interval")) {
+        settings->setValue("Log/flush_interval", 1000);
+    }
+    if (!settings->contains("Log/flush_threshold")) {
+        settings->setValue("Log/flush_threshold", 64);
+    }
+    if (!settings->contains("Log/queue_capacity")) {
+        settings->setValue("Log/queue_capacity", 10000);
+    }
+    if (!settings->contains("Log/level")) {
+        settings->setValue("Log/level", "info");
+    }
+    if (!settings->contains("Log/payload_max_bytes")) {
+        settings->setValue("Log/payload_max_bytes", 512);
+    }
+    if (!settings->contains("Log/payload_sample_rate")) {
+        settings->setValue("Log/payload_sample_rate", 1);
+    }
+    if (!settings->contains("Log/format")) {
+        settings->setValue("Log/format", "text");
+    }
     settings->sync();
+    
+    publishSnapshot();
 }
 
 void ConfigManager::saveConfig()
 {
     settings->sync();
+    publishSnapshot();
+    emit configChanged();
+}
+
+void ConfigManager::reload()
+{
+    settings->sync();
+    publishSnapshot();
+    emit configChanged();
+}
+
+ConfigSnapshotPtr ConfigManager::snapshot() const
+{
+    return std::atomic_load(&m_snapshot);
+}
+
+void ConfigManager::publishSnapshot()
+{
+    // 在这里一次性完成字符串查找、类型转换和校验，之后读取只是指针访问
+    std::shared_ptr<ConfigSnapshot> next = std::make_shared<ConfigSnapshot>();
+    next->mqttHost = getMqttHost();
+    next->mqttPort = getMqttPort();
+    next->mqttSubscribeTopic = getMqttSubscribeTopic();
+    next->mqttSubscriptions = getMqttSubscriptions();
+    next->mqttReconnectPolicy = getMqttReconnectPolicy();
+    next->mqttReconnectInterval = getMqttReconnectInterval();
+    next->mqttReconnectMin = getMqttReconnectMin();
+    next->mqttReconnectMax = getMqttReconnectMax();
+    next->mqttClientId = getMqttClientId();
+    next->mqttCleanSession = getMqttCleanSession();
+    next->mqttDedupCapacity = getMqttDedupCapacity();
+    next->mqttDedupWindow = getMqttDedupWindow();
+    next->inboundCapacity = getInboundCapacity();
+    next->inboundHighWatermark = getInboundHighWatermark();
+    next->inboundLowWatermark = getInboundLowWatermark();
+    next->inboundPolicy = getInboundPolicy();
+    next->inboundSampleEvery = getInboundSampleEvery();
+    next->inboundRateLimit = getInboundRateLimit();
+    next->syncEnabled = getSyncEnabled();
+    next->syncQuietMs = getSyncQuietMs();
+    next->syncMaxMs = getSyncMaxMs();
+    
+    next->notificationDuration = getNotificationDuration();
+    next->notificationSoundPath = getNotificationSoundPath();
+    next->notificationSoundVolume = getNotificationSoundVolume();
+    next->notificationSoundLoop = getNotificationSoundLoop();
+    next->notificationMaxVisible = getNotificationMaxVisible();
+    next->notificationRenderer = getNotificationRenderer();
+    next->notificationSounds = getNotificationSounds();
+    
+    next->eventPriorities = getEventPriorities();
+    next->schedulerQueueCapacity = getSchedulerQueueCapacity();
+    next->priorityDurations.clear();
+    next->prioritySoundLoops.clear();
+    for (int priority = 0; priority < DoorEvent::PriorityCount; ++priority) {
+        next->priorityDurations.append(getPriorityDuration(priority));
+        next->prioritySoundLoops.append(getPrioritySoundLoop(priority));
+    }
+    
+    next->coalesceEnabled = getCoalesceEnabled();
+    next->coalescePairWindow = getCoalescePairWindow();
+    next->coalesceBurstThreshold = getCoalesceBurstThreshold();
+    next->coalesceBurstWindow = getCoalesceBurstWindow();
+    
+    next->headlessSink = getHeadlessSink();
+    next->headlessSocketName = getHeadlessSocketName();
+    
+    next->metricsEnabled = getMetricsEnabled();
+    next->metricsPort = getMetricsPort();
+    
+    next->captureEnabled = getCaptureEnabled();
+    next->captureDir = getCaptureDir();
+    
+    next->startupStrategy = getStartupStrategy();
+    
+    next->historyEnabled = getHistoryEnabled();
+    next->historyPath = getHistoryPath();
+    next->historyCapacity = getHistoryCapacity();
+    next->historyHeapBytes = getHistoryHeapBytes();
+    
+    next->logPath = getLogPath();
+    next->logRetentionDays = getLogRetentionDays();
+    next->logMaxFileSize = getLogMaxFileSize();
+    next->logMaxFiles = getLogMaxFiles();
+    next->logCompress = getLogCompress();
+    next->logAsync = getLogAsync();
+    next->logFlushInterval = getLogFlushInterval();
+    next->logFlushThreshold = getLogFlushThreshold();
+    next->logQueueCapacity = getLogQueueCapacity();
+    next->logLevel = getLogLevel();
+    next->logLevelMqtt = getLogCategoryLevel("mqtt");
+    next->logLevelUi = getLogCategoryLevel("ui");
+    next->logLevelConfig = getLogCategoryLevel("config");
+    next->logPayloadMaxBytes = getLogPayloadMaxBytes();
+    next->logPayloadSampleRate = getLogPayloadSampleRate();
+    next->logFormat = getLogFormat();
+    
+    ConfigSnapshotPtr published = next;
+    std::atomic_store(&m_snapshot, published);
 }
 
 QString ConfigManager::getMqttHost() const
@@ -88,7 +353,148 @@ quint16 ConfigManager::getMqttPort() const
 
 QString ConfigManager::getMqttSubscribeTopic() const
 {
-    return settings->value("MQTT/subscribe_topic", "door-events").toString();
+    // QSettings 会把含逗号的值读成列表，这里还原成原始写法
+    return settings->value("MQTT/subscribe_topic", "door-events").toStringList().join(",");
+}
+
+int ConfigManager::getMqttSubscribeQos() const
+{
+    return qBound(0, settings->value("MQTT/subscribe_qos", 0).toInt(), 2);
+}
+
+QHash<QString, int> ConfigManager::getMqttSubscriptions() const
+{
+    // subscribe_topic 支持逗号分隔的多个主题，单个主题可用 topic@qos 指定 QoS
+    QHash<QString, int> subscriptions;
+    int defaultQos = getMqttSubscribeQos();
+    const QStringList entries = getMqttSubscribeTopic().split(',', Qt::SkipEmptyParts);
+    for (const QString &entry : entries) {
+        QString filter = entry.trimmed();
+        int qos = defaultQos;
+        int at = filter.lastIndexOf('@');
+        if (at > 0) {
+            bool ok = false;
+            int value = filter.mid(at + 1).trimmed().toInt(&ok);
+            if (ok) {
+                qos = qBound(0, value, 2);
+                filter = filter.left(at).trimmed();
+            }
+        }
+        if (!filter.isEmpty()) {
+            subscriptions.insert(filter, qos);
+        }
+    }
+    return subscriptions;
+}
+
+QString ConfigManager::getMqttReconnectPolicy() const
+{
+    QString policy = settings->value("MQTT/reconnect_policy", "exponential").toString().trimmed().toLower();
+    return policy == "fixed" ? policy : QString("exponential");
+}
+
+int ConfigManager::getMqttReconnectInterval() const
+{
+    return qMax(0, settings->value("MQTT/reconnect_interval_ms", 5000).toInt());
+}
+
+int ConfigManager::getMqttReconnectMin() const
+{
+    return qMax(0, settings->value("MQTT/reconnect_min_ms", 1000).toInt());
+}
+
+int ConfigManager::getMqttReconnectMax() const
+{
+    return qMax(getMqttReconnectMin(), settings->value("MQTT/reconnect_max_ms", 60000).toInt());
+}
+
+QString ConfigManager::getMqttClientId() const
+{
+    QString clientId = settings->value("MQTT/client_id").toString().trimmed();
+    if (!clientId.isEmpty()) {
+        return clientId;
+    }
+    
+    // 清除会话不需要固定的 ID，留空由 MqttClient 生成随机 ID
+    if (getMqttCleanSession()) {
+        return QString();
+    }
+    
+    // 持久会话由本机标识和配置文件路径派生，同一实例每次启动得到相同的 ID 才能恢复会话，
+    // 同一台机器上使用不同配置文件的多个实例不会互相踢下线
+    QByteArray machineId = QSysInfo::machineUniqueId();
+    if (machineId.isEmpty()) {
+        machineId = QSysInfo::machineHostName().toUtf8();
+    }
+    machineId += '\n';
+    machineId += QDir::cleanPath(configFilePath).toUtf8();
+    QByteArray digest = QCryptographicHash::hash(machineId, QCryptographicHash::Sha1).toHex();
+    return QString("DoorStateClient-%1").arg(QString::fromLatin1(digest.left(12)));
+}
+
+bool ConfigManager::getMqttCleanSession() const
+{
+    return settings->value("MQTT/clean_session", true).toBool();
+}
+
+int ConfigManager::getMqttDedupCapacity() const
+{
+    return qMax(0, settings->value("MQTT/dedup_capacity", 1024).toInt());
+}
+
+int ConfigManager::getMqttDedupWindow() const
+{
+    return qMax(0, settings->value("MQTT/dedup_window_ms", 60000).toInt());
+}
+
+int ConfigManager::getInboundCapacity() const
+{
+    return qBound(2, settings->value("Inbound/capacity", 5000).toInt(), 1000000);
+}
+
+int ConfigManager::getInboundHighWatermark() const
+{
+    return qBound(2, settings->value("Inbound/high_watermark", 4000).toInt(), getInboundCapacity());
+}
+
+int ConfigManager::getInboundLowWatermark() const
+{
+    // 低水位必须低于高水位，否则过载状态无法退出
+    return qBound(1, settings->value("Inbound/low_watermark", 1000).toInt(), getInboundHighWatermark() - 1);
+}
+
+QString ConfigManager::getInboundPolicy() const
+{
+    QString policy = settings->value("Inbound/policy", "drop_oldest").toString().trimmed().toLower();
+    if (policy != "sample") {
+        policy = "drop_oldest";
+    }
+    return policy;
+}
+
+int ConfigManager::getInboundSampleEvery() const
+{
+    return qBound(1, settings->value("Inbound/sample_every", 10).toInt(), 10000);
+}
+
+int ConfigManager::getInboundRateLimit() const
+{
+    return qMax(0, settings->value("Inbound/rate_limit", 500).toInt());
+}
+
+bool ConfigManager::getSyncEnabled() const
+{
+    return settings->value("Sync/enabled", true).toBool();
+}
+
+int ConfigManager::getSyncQuietMs() const
+{
+    return qBound(10, settings->value("Sync/quiet_ms", 500).toInt(), 60000);
+}
+
+int ConfigManager::getSyncMaxMs() const
+{
+    return qBound(getSyncQuietMs(), settings->value("Sync/max_ms", 5000).toInt(), 600000);
 }
 
 int ConfigManager::getNotificationDuration() const
@@ -120,6 +526,166 @@ QString ConfigManager::getNotificationSoundLoop() const
     return mode;
 }
 
+int ConfigManager::getNotificationMaxVisible() const
+{
+    int count = settings->value("Notification/max_visible", 3).toInt();
+    // 至少显示 1 条，最多堆叠 10 条
+    return qBound(1, count, 10);
+}
+
+QString ConfigManager::getNotificationRenderer() const
+{
+    QString renderer = settings->value("Notification/renderer", "stylesheet").toString().trimmed().toLower();
+    if (renderer != "painted") {
+        renderer = "stylesheet";
+    }
+    return renderer;
+}
+
+QHash<QString, QString> ConfigManager::getNotificationSounds() const
+{
+    // [Sounds] 分组：事件类型 = 音频文件路径
+    QHash<QString, QString> sounds;
+    settings->beginGroup("Sounds");
+    const QStringList eventTypes = settings->childKeys();
+    for (const QString &eventType : eventTypes) {
+        sounds.insert(eventType, settings->value(eventType).toString());
+    }
+    settings->endGroup();
+    return sounds;
+}
+
+QHash<QString, int> ConfigManager::getEventPriorities() const
+{
+    // [Priority] 分组：事件类型 = 优先级名称，无法识别的条目忽略
+    QHash<QString, int> priorities;
+    settings->beginGroup("Priority");
+    const QStringList eventTypes = settings->childKeys();
+    for (const QString &eventType : eventTypes) {
+        DoorEvent::Priority priority;
+        if (DoorEvent::priorityFromString(settings->value(eventType).toString(), &priority)) {
+            priorities.insert(eventType, priority);
+        }
+    }
+    settings->endGroup();
+    return priorities;
+}
+
+int ConfigManager::getSchedulerQueueCapacity() const
+{
+    int capacity = settings->value("Scheduler/queue_capacity", 20).toInt();
+    return qBound(0, capacity, 1000);
+}
+
+int ConfigManager::getPriorityDuration(int priority) const
+{
+    QString name = DoorEvent::priorityName(DoorEvent::Priority(priority));
+    int duration = settings->value(QString("Scheduler/%1_duration").arg(name), 0).toInt();
+    if (duration <= 0) {
+        return getNotificationDuration();
+    }
+    return qBound(500, duration, 3600000);
+}
+
+QString ConfigManager::getPrioritySoundLoop(int priority) const
+{
+    QString name = DoorEvent::priorityName(DoorEvent::Priority(priority));
+    QString mode = settings->value(QString("Scheduler/%1_sound_loop").arg(name), "").toString().trimmed().toLower();
+    if (mode != "once" && mode != "loop") {
+        return getNotificationSoundLoop();
+    }
+    return mode;
+}
+
+bool ConfigManager::getCoalesceEnabled() const
+{
+    return settings->value("Coalesce/enabled", true).toBool();
+}
+
+int ConfigManager::getCoalescePairWindow() const
+{
+    return settings->value("Coalesce/pair_window_ms", 1000).toInt();
+}
+
+int ConfigManager::getCoalesceBurstThreshold() const
+{
+    return settings->value("Coalesce/burst_threshold", 5).toInt();
+}
+
+int ConfigManager::getCoalesceBurstWindow() const
+{
+    return settings->value("Coalesce/burst_window_ms", 5000).toInt();
+}
+
+QString ConfigManager::getHeadlessSink() const
+{
+    QString sink = settings->value("Headless/sink", "log").toString().trimmed().toLower();
+    if (sink != "stdout" && sink != "socket") {
+        sink = "log";
+    }
+    return sink;
+}
+
+QString ConfigManager::getHeadlessSocketName() const
+{
+    QString name = settings->value("Headless/socket_name", "DoorStateClient").toString().trimmed();
+    return name.isEmpty() ? QString("DoorStateClient") : name;
+}
+
+bool ConfigManager::getMetricsEnabled() const
+{
+    return settings->value("Metrics/enabled", false).toBool();
+}
+
+quint16 ConfigManager::getMetricsPort() const
+{
+    int port = settings->value("Metrics/port", 9464).toInt();
+    return quint16(port > 0 && port <= 65535 ? port : 9464);
+}
+
+bool ConfigManager::getCaptureEnabled() const
+{
+    return settings->value("Capture/enabled", false).toBool();
+}
+
+QString ConfigManager::getCaptureDir() const
+{
+    QString dir = settings->value("Capture/dir", "./captures").toString().trimmed();
+    return dir.isEmpty() ? QString("./captures") : dir;
+}
+
+QString ConfigManager::getStartupStrategy() const
+{
+    QString strategy = settings->value("Startup/strategy", "prewarm").toString().trimmed().toLower();
+    if (strategy != "lazy") {
+        strategy = "prewarm";
+    }
+    return strategy;
+}
+
+bool ConfigManager::getHistoryEnabled() const
+{
+    return settings->value("History/enabled", true).toBool();
+}
+
+QString ConfigManager::getHistoryPath() const
+{
+    QString path = settings->value("History/path", "./history/events.ring").toString().trimmed();
+    return path.isEmpty() ? QString("./history/events.ring") : path;
+}
+
+int ConfigManager::getHistoryCapacity() const
+{
+    int capacity = settings->value("History/capacity", 10000).toInt();
+    return qBound(64, capacity, 10000000);
+}
+
+int ConfigManager::getHistoryHeapBytes() const
+{
+    int bytes = settings->value("History/heap_bytes", 1048576).toInt();
+    return qBound(4096, bytes, 256 * 1024 * 1024);
+}
+
 QString ConfigManager::getLogPath() const
 {
     return settings->value("Log/path", "./logs").toString();
@@ -130,6 +696,74 @@ int ConfigManager::getLogRetentionDays() const
     return settings->value("Log/retention_days", 7).toInt();
 }
 
+qint64 ConfigManager::getLogMaxFileSize() const
+{
+    return qMax<qint64>(0, settings->value("Log/max_file_size", 10485760).toLongLong());
+}
+
+int ConfigManager::getLogMaxFiles() const
+{
+    return qMax(0, settings->value("Log/max_files", 50).toInt());
+}
+
+bool ConfigManager::getLogCompress() const
+{
+    return settings->value("Log/compress", true).toBool();
+}
+
+bool ConfigManager::getLogAsync() const
+{
+    return settings->value("Log/async", true).toBool();
+}
+
+int ConfigManager::getLogFlushInterval() const
+{
+    return settings->value("Log/flush_interval", 1000).toInt();
+}
+
+int ConfigManager::getLogFlushThreshold() const
+{
+    return settings->value("Log/flush_threshold", 64).toInt();
+}
+
+int ConfigManager::getLogQueueCapacity() const
+{
+    return settings->value("Log/queue_capacity", 10000).toInt();
+}
+
+QString ConfigManager::getLogLevel() const
+{
+    return settings->value("Log/level", "info").toString();
+}
+
+QString ConfigManager::getLogCategoryLevel(const QString &category) const
+{
+    // 分类级别为空时沿用全局级别，例如 level_mqtt=debug
+    return settings->value(QString("Log/level_%1").arg(category), "").toString();
+}
+
+int ConfigManager::getLogPayloadMaxBytes() const
+{
+    return settings->value("Log/payload_max_bytes", 512).toInt();
+}
+
+int ConfigManager::getLogPayloadSampleRate() const
+{
+    return settings->value("Log/payload_sample_rate", 1).toInt();
+}
+
+QString ConfigManager::getLogFormat() const
+{
+    QString format = settings->value("Log/format", "text").toString().trimmed().toLower();
+    if (format == "json") {
+        format = "jsonl";
+    }
+    if (format != "jsonl") {
+        format = "text";
+    }
+    return format;
+}
+
 void ConfigManager::setMqttHost(const QString &host)
 {
     settings->setValue("MQTT/host", host);
@@ -3,23 +3,167 @@
 
 #include <QObject>
 #include <QSettings>
+#include <QHash>
+#include <QVector>
+#include <QStringList>
+#include <QAtomicPointer>
+#include <memory>
+
+// 配置快照：加载时校验并固定下来的只读配置
+// 事件处理路径读取快照，不再访问 QSettings；配置变化时整体替换
+struct ConfigSnapshot
+{
+    QString mqttHost;
+    quint16 mqttPort;
+    QString mqttSubscribeTopic;
+    QHash<QString, int> mqttSubscriptions;  // 主题过滤器 -> QoS，已去重和校验
+    QString mqttReconnectPolicy;            // 只会是 "fixed" 或 "exponential"
+    int mqttReconnectInterval;
+    int mqttReconnectMin;
+    int mqttReconnectMax;                   // 不小于 mqttReconnectMin
+    QString mqttClientId;                   // 未配置时：持久会话由本机标识和配置路径派生，清除会话为空（随机 ID）
+    bool mqttCleanSession;
+    int mqttDedupCapacity;
+    int mqttDedupWindow;                    // 毫秒
+    int inboundCapacity;
+    int inboundHighWatermark;               // 已保证 inboundLowWatermark < inboundHighWatermark <= inboundCapacity
+    int inboundLowWatermark;
+    QString inboundPolicy;                  // 只会是 "drop_oldest" 或 "sample"
+    int inboundSampleEvery;
+    int inboundRateLimit;                   // 每秒处理的消息数，0 表示不限速
+    bool syncEnabled;
+    int syncQuietMs;
+    int syncMaxMs;                          // 不小于 syncQuietMs
+    
+    int notificationDuration;
+    QString notificationSoundPath;
+    qreal notificationSoundVolume;   // 已限制在 0.0 - 1.0
+    QString notificationSoundLoop;   // 只会是 "once" 或 "loop"
+    int notificationMaxVisible;
+    QString notificationRenderer;  // 只会是 "stylesheet" 或 "painted"
+    QHash<QString, QString> notificationSounds;
+    
+    QHash<QString, int> eventPriorities;   // 事件类型 -> DoorEvent::Priority，已校验
+    int schedulerQueueCapacity;
+    QVector<int> priorityDurations;        // 按优先级索引，未单独配置的已替换为 notificationDuration
+    QStringList prioritySoundLoops;        // 按优先级索引，只会是 "once" 或 "loop"
+    
+    bool coalesceEnabled;
+    int coalescePairWindow;
+    int coalesceBurstThreshold;
+    int coalesceBurstWindow;
+    
+    QString headlessSink;        // 只会是 "log"、"stdout" 或 "socket"
+    QString headlessSocketName;
+    
+    bool metricsEnabled;
+    quint16 metricsPort;
+    
+    bool captureEnabled;
+    QString captureDir;
+    
+    QString startupStrategy;     // 只会是 "lazy" 或 "prewarm"
+    
+    bool historyEnabled;
+    QString historyPath;
+    int historyCapacity;
+    int historyHeapBytes;
+    
+    QString logPath;
+    int logRetentionDays;
+    qint64 logMaxFileSize;
+    int logMaxFiles;
+    bool logCompress;
+    bool logAsync;
+    int logFlushInterval;
+    int logFlushThreshold;
+    int logQueueCapacity;
+    QString logLevel;
+    QString logLevelMqtt;
+    QString logLevelUi;
+    QString logLevelConfig;
+    int logPayloadMaxBytes;
+    int logPayloadSampleRate;
+    QString logFormat;           // 只会是 "text" 或 "jsonl"
+};
+
+typedef std::shared_ptr<const ConfigSnapshot> ConfigSnapshotPtr;
 
 class ConfigManager : public QObject
 {
     Q_OBJECT
 
 public:
+    // instance() 线程安全；get/set 方法访问 QSettings，只能在主线程调用
     static ConfigManager* instance(const QString &configPath = QString());
     
+    // 当前配置快照，可在任意线程调用；只在复制指针时短暂加锁（std::atomic_load 由标准库用内部锁实现），开销很小
+    ConfigSnapshotPtr snapshot() const;
+    // 重新读取配置文件并发布新快照
+    void reload();
+    
     QString getMqttHost() const;
     quint16 getMqttPort() const;
     QString getMqttSubscribeTopic() const;
+    int getMqttSubscribeQos() const;
+    QHash<QString, int> getMqttSubscriptions() const;
+    QString getMqttReconnectPolicy() const;
+    int getMqttReconnectInterval() const;
+    int getMqttReconnectMin() const;
+    int getMqttReconnectMax() const;
+    QString getMqttClientId() const;
+    bool getMqttCleanSession() const;
+    int getMqttDedupCapacity() const;
+    int getMqttDedupWindow() const;
+    int getInboundCapacity() const;
+    int getInboundHighWatermark() const;
+    int getInboundLowWatermark() const;
+    QString getInboundPolicy() const;
+    int getInboundSampleEvery() const;
+    int getInboundRateLimit() const;
+    bool getSyncEnabled() const;
+    int getSyncQuietMs() const;
+    int getSyncMaxMs() const;
     int getNotificationDuration() const;
     QString getNotificationSoundPath() const;
     qreal getNotificationSoundVolume() const;
     QString getNotificationSoundLoop() const;
+    int getNotificationMaxVisible() const;
+    QString getNotificationRenderer() const;
+    QHash<QString, QString> getNotificationSounds() const;
+    QHash<QString, int> getEventPriorities() const;
+    int getSchedulerQueueCapacity() const;
+    int getPriorityDuration(int priority) const;
+    QString getPrioritySoundLoop(int priority) const;
+    bool getCoalesceEnabled() const;
+    int getCoalescePairWindow() const;
+    int getCoalesceBurstThreshold() const;
+    int getCoalesceBurstWindow() const;
+    QString getHeadlessSink() const;
+    QString getHeadlessSocketName() const;
+    bool getMetricsEnabled() const;
+    quint16 getMetricsPort() const;
+    bool getCaptureEnabled() const;
+    QString getCaptureDir() const;
+    QString getStartupStrategy() const;
+    bool getHistoryEnabled() const;
+    QString getHistoryPath() const;
+    int getHistoryCapacity() const;
+    int getHistoryHeapBytes() const;
     QString getLogPath() const;
     int getLogRetentionDays() const;
+    qint64 getLogMaxFileSize() const;
+    int getLogMaxFiles() const;
+    bool getLogCompress() const;
+    bool getLogAsync() const;
+    int getLogFlushInterval() const;
+    int getLogFlushThreshold() const;
+    int getLogQueueCapacity() const;
+    QString getLogLevel() const;
+    QString getLogCategoryLevel(const QString &category) const;
+    int getLogPayloadMaxBytes() const;
+    int getLogPayloadSampleRate() const;
+    QString getLogFormat() const;
     
     void setMqttHost(const QString &host);
     void setMqttPort(quint16 port);
@@ -31,14 +175,19 @@ public:
     void setLogPath(const QString &path);
     void setLogRetentionDays(int days);
     
+signals:
+    void configChanged();
+
 private:
     explicit ConfigManager(const QString &configPath, QObject *parent = nullptr);
     void loadConfig();
     void saveConfig();
+    void publishSnapshot();
     
-    static ConfigManager *m_instance;
+    static QAtomicPointer<ConfigManager> m_instance;
     QSettings *settings;
     QString configFilePath;
+    ConfigSnapshotPtr m_snapshot;  // 只通过 std::atomic_load/atomic_store 访问
 };
 
 #endif // CONFIGMANAGER_H
@@ -0,0 +1,600 @@
+#include "doorevent.h"
+#include <QJsonDocument>
+#include <QJsonValue>
+#include <cstring>
+
+namespace {
+
+// 客户端关心的字段
+enum FieldId {
+    FieldUnknown,
+    FieldEvent,
+    FieldMessage,
+    FieldTimestamp,
+    FieldDoorId,       // door_id
+    FieldDoorIdAlias,  // doorId，同时出现时以 door_id 为准
+    FieldPriority
+};
+
+FieldId fieldFromKey(const char *key, int length)
+{
+    switch (length) {
+    case 5:
+        if (std::memcmp(key, "event", 5) == 0) return FieldEvent;
+        break;
+    case 6:
+        if (std::memcmp(key, "doorId", 6) == 0) return FieldDoorIdAlias;
+        break;
+    case 7:
+        if (std::memcmp(key, "message", 7) == 0) return FieldMessage;
+        if (std::memcmp(key, "door_id", 7) == 0) return FieldDoorId;
+        break;
+    case 8:
+        if (std::memcmp(key, "priority", 8) == 0) return FieldPriority;
+        break;
+    case 9:
+        if (std::memcmp(key, "timestamp", 9) == 0) return FieldTimestamp;
+        break;
+    default:
+        break;
+    }
+    return FieldUnknown;
+}
+
+// 数字字段统一按 double 转成文本，快速解析和 QJsonDocument 得到相同的键（"1.0"、"1e0" 都是 "1"）
+QString numberText(double value)
+{
+    return QString::number(value, 'g', 15);
+}
+
+int hexValue(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+int digitsValue(const QChar *digits, int count)
+{
+    int value = 0;
+    for (int i = 0; i < count; ++i) {
+        ushort c = digits[i].unicode();
+        if (c < '0' || c > '9') {
+            return -1;
+        }
+        value = value * 10 + (c - '0');
+    }
+    return value;
+}
+
+// 按 JSON 数字语法校验：-?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+bool isJsonNumber(const char *p, int length)
+{
+    const char *end = p + length;
+    if (p < end && *p == '-') {
+        ++p;
+    }
+    if (p >= end || *p < '0' || *p > '9') {
+        return false;
+    }
+    if (*p == '0') {
+        ++p;
+    } else {
+        while (p < end && *p >= '0' && *p <= '9') {
+            ++p;
+        }
+    }
+    if (p < end && *p == '.') {
+        ++p;
+        if (p >= end || *p < '0' || *p > '9') {
+            return false;
+        }
+        while (p < end && *p >= '0' && *p <= '9') {
+            ++p;
+        }
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        ++p;
+        if (p < end && (*p == '+' || *p == '-')) {
+            ++p;
+        }
+        if (p >= end || *p < '0' || *p > '9') {
+            return false;
+        }
+        while (p < end && *p >= '0' && *p <= '9') {
+            ++p;
+        }
+    }
+    return p == end;
+}
+
+// 在原始 UTF-8 字节上顺序扫描，不分配中间对象
+class PayloadScanner
+{
+public:
+    PayloadScanner(const char *begin, const char *end)
+        : m_pos(begin)
+        , m_end(end)
+    {
+    }
+    
+    void skipWhitespace()
+    {
+        while (m_pos < m_end && (*m_pos == ' ' || *m_pos == '\t' || *m_pos == '\n' || *m_pos == '\r')) {
+            ++m_pos;
+        }
+    }
+    
+    bool atEnd()
+    {
+        skipWhitespace();
+        return m_pos >= m_end;
+    }
+    
+    char peek()
+    {
+        skipWhitespace();
+        return m_pos < m_end ? *m_pos : '\0';
+    }
+    
+    bool consume(char expected)
+    {
+        if (peek() == expected && m_pos < m_end) {
+            ++m_pos;
+            return true;
+        }
+        return false;
+    }
+    
+    // 读取键名原始字节，键名含转义时返回 false（交给通用解析）
+    bool readRawKey(const char **key, int *length)
+    {
+        if (!consume('"')) {
+            return false;
+        }
+        const char *start = m_pos;
+        while (m_pos < m_end && *m_pos != '"') {
+            if (*m_pos == '\\') {
+                return false;
+            }
+            ++m_pos;
+        }
+        if (m_pos >= m_end) {
+            return false;
+        }
+        *key = start;
+        *length = int(m_pos - start);
+        ++m_pos;
+        return true;
+    }
+    
+    // 读取并解码字符串，out 为空时只跳过
+    bool readString(QString *out)
+    {
+        if (!consume('"')) {
+            return false;
+        }
+        
+        const char *chunk = m_pos;
+        QString decoded;
+        bool hasEscape = false;
+        while (m_pos < m_end) {
+            char c = *m_pos;
+            if (c == '"') {
+                if (out) {
+                    QString tail = QString::fromUtf8(chunk, int(m_pos - chunk));
+                    *out = hasEscape ? decoded + tail : tail;
+                }
+                ++m_pos;
+                return true;
+            }
+            if (static_cast<uchar>(c) < 0x20) {
+                // JSON 字符串中不允许出现未转义的控制字符
+                return false;
+            }
+            if (c != '\\') {
+                ++m_pos;
+                continue;
+            }
+            
+            // 转义序列：先把之前的原始片段追加到结果中
+            if (out) {
+                decoded += QString::fromUtf8(chunk, int(m_pos - chunk));
+            }
+            hasEscape = true;
+            ++m_pos;
+            if (m_pos >= m_end) {
+                return false;
+            }
+            
+            QChar ch;
+            switch (*m_pos) {
+            case '"': ch = QLatin1Char('"'); break;
+            case '\\': ch = QLatin1Char('\\'); break;
+            case '/': ch = QLatin1Char('/'); break;
+            case 'b': ch = QChar(0x08); break;
+            case 'f': ch = QChar(0x0C); break;
+            case 'n': ch = QLatin1Char('\n'); break;
+            case 'r': ch = QLatin1Char('\r'); break;
+            case 't': ch = QLatin1Char('\t'); break;
+            case 'u': {
+                if (m_end - m_pos < 5) {
+                    return false;
+                }
+                ushort code = 0;
+                for (int i = 1; i <= 4; ++i) {
+                    int digit = hexValue(m_pos[i]);
+                    if (digit < 0) {
+                        return false;
+                    }
+                    code = ushort((code << 4) | digit);
+                }
+                // 代理对按两个 UTF-16 码元依次追加即可
+                ch = QChar(code);
+                m_pos += 4;
+                break;
+            }
+            default:
+                return false;
+            }
+            
+            if (out) {
+                decoded += ch;
+            }
+            ++m_pos;
+            chunk = m_pos;
+        }
+        return false;
+    }
+    
+    // 读取数字或 true/false/null 的原始文本
+    bool readScalar(const char **start, int *length)
+    {
+        skipWhitespace();
+        const char *begin = m_pos;
+        while (m_pos < m_end) {
+            char c = *m_pos;
+            if ((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z')
+                    || c == '-' || c == '+' || c == '.' || c == 'E') {
+                ++m_pos;
+            } else {
+                break;
+            }
+        }
+        
+        int size = int(m_pos - begin);
+        if (size == 0) {
+            return false;
+        }
+        if (*begin >= 'a' && *begin <= 'z') {
+            bool literal = (size == 4 && (std::memcmp(begin, "true", 4) == 0 || std::memcmp(begin, "null", 4) == 0))
+                    || (size == 5 && std::memcmp(begin, "false", 5) == 0);
+            if (!literal) {
+                return false;
+            }
+        } else if (!isJsonNumber(begin, size)) {
+            // 12abc、1x、01 之类不是合法的 JSON 数字，交给通用解析按错误处理
+            return false;
+        }
+        
+        *start = begin;
+        *length = size;
+        return true;
+    }
+    
+    // 跳过任意 JSON 值，嵌套对象/数组按深度限制递归
+    bool skipValue(int depth = 0)
+    {
+        if (depth > 64) {
+            return false;
+        }
+        
+        char c = peek();
+        if (c == '"') {
+            return readString(nullptr);
+        }
+        if (c == '{') {
+            ++m_pos;
+            if (consume('}')) {
+                return true;
+            }
+            do {
+                if (!readString(nullptr) || !consume(':') || !skipValue(depth + 1)) {
+                    return false;
+                }
+            } while (consume(','));
+            return consume('}');
+        }
+        if (c == '[') {
+            ++m_pos;
+            if (consume(']')) {
+                return true;
+            }
+            do {
+                if (!skipValue(depth + 1)) {
+                    return false;
+                }
+            } while (consume(','));
+            return consume(']');
+        }
+        
+        const char *start = nullptr;
+        int length = 0;
+        return readScalar(&start, &length);
+    }
+    
+    // 读取已知字段的值：字符串解码，数字保留原始文本并置 isNumber，其余类型视为空字符串
+    bool readFieldValue(QString *value, bool *isNumber)
+    {
+        *isNumber = false;
+        char c = peek();
+        if (c == '"') {
+            return readString(value);
+        }
+        if (c == '{' || c == '[') {
+            value->clear();
+            return skipValue();
+        }
+        
+        const char *start = nullptr;
+        int length = 0;
+        if (!readScalar(&start, &length)) {
+            return false;
+        }
+        if (*start >= 'a' && *start <= 'z') {
+            value->clear();
+        } else {
+            *value = QString::fromLatin1(start, length);
+            *isNumber = true;
+        }
+        return true;
+    }
+
+private:
+    const char *m_pos;
+    const char *m_end;
+};
+
+} // namespace
+
+DoorEvent::DoorEvent()
+    : priority(Normal)
+    , hasEvent(false)
+    , hasMessage(false)
+    , hasTimestamp(false)
+    , hasDoorId(false)
+    , hasPriority(false)
+    , receivedAtMs(0)
+    , receivedAtUs(0)
+    , parsedAtUs(0)
+{
+}
+
+bool DoorEvent::fromPayload(const QByteArray &payload, DoorEvent *event)
+{
+    if (parseFast(payload, event)) {
+        return true;
+    }
+    return parseJson(payload, event);
+}
+
+bool DoorEvent::parseFast(const QByteArray &payload, DoorEvent *event)
+{
+    DoorEvent result;
+    bool hasSnakeDoorId = false;  // 已经读到 door_id，之后的 doorId 不再覆盖
+    PayloadScanner scanner(payload.constData(), payload.constData() + payload.size());
+    
+    if (!scanner.consume('{')) {
+        return false;
+    }
+    
+    if (!scanner.consume('}')) {
+        do {
+            const char *key = nullptr;
+            int keyLength = 0;
+            if (!scanner.readRawKey(&key, &keyLength) || !scanner.consume(':')) {
+                return false;
+            }
+            
+            FieldId field = fieldFromKey(key, keyLength);
+            if (field == FieldUnknown) {
+                if (!scanner.skipValue()) {
+                    return false;
+                }
+                continue;
+            }
+            
+            QString value;
+            bool isNumber = false;
+            if (!scanner.readFieldValue(&value, &isNumber)) {
+                return false;
+            }
+            
+            // 与通用解析保持一致：门编号和优先级的数字规范化，其余字段的数字视为空字符串
+            if (isNumber) {
+                if (field == FieldDoorId || field == FieldDoorIdAlias || field == FieldPriority) {
+                    value = numberText(value.toDouble());
+                } else {
+                    value.clear();
+                }
+            }
+            
+            switch (field) {
+            case FieldEvent:
+                result.event = value;
+                result.hasEvent = true;
+                break;
+            case FieldMessage:
+                result.message = value;
+                result.hasMessage = true;
+                break;
+            case FieldTimestamp:
+                result.timestamp = value;
+                result.hasTimestamp = true;
+                break;
+            case FieldDoorId:
+                result.doorId = value;
+                result.hasDoorId = true;
+                hasSnakeDoorId = true;
+                break;
+            case FieldDoorIdAlias:
+                // 与通用解析保持一致：两种写法都有时以 door_id 为准，与出现顺序无关
+                if (!hasSnakeDoorId) {
+                    result.doorId = value;
+                    result.hasDoorId = true;
+                }
+                break;
+            case FieldPriority:
+                result.hasPriority = priorityFromString(value, &result.priority);
+                break;
+            default:
+                break;
+            }
+        } while (scanner.consume(','));
+        
+        if (!scanner.consume('}')) {
+            return false;
+        }
+    }
+    
+    if (!scanner.atEnd()) {
+        return false;
+    }
+    
+    if (result.hasTimestamp) {
+        result.dateTime = parseTimestamp(result.timestamp);
+    }
+    
+    *event = result;
+    return true;
+}
+
+bool DoorEvent::parseJson(const QByteArray &payload, DoorEvent *event)
+{
+    QJsonDocument doc = QJsonDocument::fromJson(payload);
+    if (!doc.isObject()) {
+        return false;
+    }
+    
+    *event = fromJsonObject(doc.object());
+    return true;
+}
+
+DoorEvent DoorEvent::fromJsonObject(const QJsonObject &object)
+{
+    DoorEvent result;
+    
+    if (object.contains("event")) {
+        result.event = object.value("event").toString();
+        result.hasEvent = true;
+    }
+    if (object.contains("message")) {
+        result.message = object.value("message").toString();
+        result.hasMessage = true;
+    }
+    if (object.contains("timestamp")) {
+        result.timestamp = object.value("timestamp").toString();
+        result.hasTimestamp = true;
+        result.dateTime = parseTimestamp(result.timestamp);
+    }
+    
+    QString doorKey = object.contains("door_id") ? QStringLiteral("door_id") : QStringLiteral("doorId");
+    if (object.contains(doorKey)) {
+        QJsonValue doorValue = object.value(doorKey);
+        result.doorId = doorValue.isDouble() ? numberText(doorValue.toDouble()) : doorValue.toString();
+        result.hasDoorId = true;
+    }
+    
+    if (object.contains("priority")) {
+        QJsonValue priorityValue = object.value("priority");
+        QString name = priorityValue.isDouble() ? numberText(priorityValue.toDouble()) : priorityValue.toString();
+        result.hasPriority = priorityFromString(name, &result.priority);
+    }
+    
+    return result;
+}
+
+bool DoorEvent::priorityFromString(const QString &name, Priority *priority)
+{
+    static const char *const names[PriorityCount] = { "low", "normal", "high", "critical" };
+    
+    QString key = name.trimmed().toLower();
+    for (int i = 0; i < PriorityCount; ++i) {
+        if (key == QLatin1String(names[i]) || key == QString::number(i)) {
+            *priority = Priority(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+QString DoorEvent::priorityName(Priority priority)
+{
+    switch (priority) {
+    case Low: return "low";
+    case High: return "high";
+    case Critical: return "critical";
+    default: return "normal";
+    }
+}
+
+QDateTime DoorEvent::parseTimestamp(const QString &timestamp)
+{
+    // 快速路径：yyyy-MM-ddTHH:mm:ss[.zzz][Z|±HH:mm]
+    const QChar *p = timestamp.constData();
+    const int length = timestamp.size();
+    
+    if (length >= 19
+            && p[4] == QLatin1Char('-') && p[7] == QLatin1Char('-') && p[10] == QLatin1Char('T')
+            && p[13] == QLatin1Char(':') && p[16] == QLatin1Char(':')) {
+        int year = digitsValue(p, 4);
+        int month = digitsValue(p + 5, 2);
+        int day = digitsValue(p + 8, 2);
+        int hour = digitsValue(p + 11, 2);
+        int minute = digitsValue(p + 14, 2);
+        int second = digitsValue(p + 17, 2);
+        
+        int pos = 19;
+        int msec = 0;
+        if (pos < length && p[pos] == QLatin1Char('.')) {
+            ++pos;
+            int digits = 0;
+            int scale = 100;
+            while (pos < length && p[pos].unicode() >= '0' && p[pos].unicode() <= '9') {
+                if (digits < 3) {
+                    msec += (p[pos].unicode() - '0') * scale;
+                    scale /= 10;
+                }
+                ++digits;
+                ++pos;
+            }
+            if (digits == 0) {
+                pos = -1;
+            }
+        }
+        
+        QDate date(year, month, day);
+        QTime time(hour, minute, second, msec);
+        if (pos > 0 && year >= 0 && date.isValid() && time.isValid()) {
+            if (pos == length) {
+                return QDateTime(date, time, Qt::LocalTime);
+            }
+            if (p[pos] == QLatin1Char('Z') && pos + 1 == length) {
+                return QDateTime(date, time, Qt::UTC);
+            }
+            if ((p[pos] == QLatin1Char('+') || p[pos] == QLatin1Char('-'))
+                    && length - pos == 6 && p[pos + 3] == QLatin1Char(':')) {
+                int offsetHours = digitsValue(p + pos + 1, 2);
+                int offsetMinutes = digitsValue(p + pos + 4, 2);
+                if (offsetHours >= 0 && offsetMinutes >= 0) {
+                    int offset = (offsetHours * 3600 + offsetMinutes * 60) * (p[pos] == QLatin1Char('-') ? -1 : 1);
+                    return QDateTime(date, time, Qt::OffsetFromUTC, offset);
+                }
+            }
+        }
+    }
+    
+    // 其他写法交给 Qt 的通用 ISO 解析
+    return QDateTime::fromString(timestamp, Qt::ISODate);
+}
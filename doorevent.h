@@ -0,0 +1,64 @@
+#ifndef DOOREVENT_H
+#define DOOREVENT_H
+
+#include <QString>
+#include <QByteArray>
+#include <QDateTime>
+#include <QJsonObject>
+#include <QMetaType>
+
+// 门禁事件，只保存客户端关心的字段
+struct DoorEvent
+{
+    // 通知优先级，数值越大越重要；高优先级的通知可以抢占低优先级的通知
+    enum Priority {
+        Low = 0,
+        Normal,
+        High,
+        Critical,
+        PriorityCount
+    };
+    
+    DoorEvent();
+    
+    QString event;       // 事件类型，例如 door_button_pressed
+    QString message;     // 服务端自定义消息
+    QString timestamp;   // 服务端原始时间戳（ISO 8601）
+    QString doorId;      // 门编号
+    QDateTime dateTime;  // 解析后的时间戳，缺失或格式错误时无效
+    Priority priority;   // 负载中的 priority 字段，缺失或无法识别时为 Normal
+    QString topic;       // 收到消息的 MQTT 主题，由 MqttClient 填写
+    
+    bool hasEvent;
+    bool hasMessage;
+    bool hasTimestamp;
+    bool hasDoorId;
+    bool hasPriority;
+    
+    // 各阶段时间，用于延迟统计；由 MqttClient 在收到/解析消息时填写，未填写时为 0
+    qint64 receivedAtMs;  // 收到消息时的本机时间（毫秒时间戳），与服务端时间戳比较
+    qint64 receivedAtUs;  // 收到消息时的单调时钟（微秒）
+    qint64 parsedAtUs;    // 解析完成时的单调时钟（微秒）
+    
+    // 解析 MQTT 负载：先走快速解析，遇到不支持的写法再回退到 QJsonDocument
+    static bool fromPayload(const QByteArray &payload, DoorEvent *event);
+    
+    // 快速解析：单次扫描，只提取已知字段，不构建 JSON DOM
+    // 遇到转义的键名等少见写法时返回 false，由调用方回退到通用解析
+    static bool parseFast(const QByteArray &payload, DoorEvent *event);
+    
+    // 通用解析：基于 QJsonDocument / QJsonObject
+    static bool parseJson(const QByteArray &payload, DoorEvent *event);
+    static DoorEvent fromJsonObject(const QJsonObject &object);
+    
+    // 解析 ISO 8601 时间戳，常见格式走快速路径，其余交给 QDateTime::fromString
+    static QDateTime parseTimestamp(const QString &timestamp);
+    
+    // 优先级名称（low/normal/high/critical）或数字 0 - 3，无法识别时返回 false
+    static bool priorityFromString(const QString &name, Priority *priority);
+    static QString priorityName(Priority priority);
+};
+
+Q_DECLARE_METATYPE(DoorEvent)
+
+#endif // DOOREVENT_H
@@ -0,0 +1,155 @@
+#include "doorstatetable.h"
+#include <QStringList>
+#include <algorithm>
+
+namespace {
+const int MaxSummaryStates = 4;  // 摘要中最多列出的状态数，托盘提示的长度有限
+}
+
+DoorStateTable::DoorStateTable()
+    : m_totalEvents(0)
+    , m_summaryDirty(true)
+{
+}
+
+bool DoorStateTable::update(const DoorEvent &event, bool live)
+{
+    // 负载中没有 door_id 时（例如每扇门一个主题的格式）用主题区分门
+    const QString key = event.hasDoorId ? event.doorId : event.topic;
+    if (key.isEmpty()) {
+        return false;
+    }
+    
+    QDateTime eventTime = event.dateTime.isValid() ? event.dateTime
+                        : event.receivedAtMs > 0 ? QDateTime::fromMSecsSinceEpoch(event.receivedAtMs)
+                        : QDateTime::currentDateTime();
+    QString state = event.hasEvent ? event.event : QString("unknown");
+    
+    QHash<QString, Door>::iterator it = m_doors.find(key);
+    if (it == m_doors.end()) {
+        Door door;
+        door.doorId = key;
+        door.state = state;
+        door.lastMessage = event.message;
+        door.stateSince = eventTime;
+        door.lastEventAt = eventTime;
+        door.eventCount = live ? 1 : 0;
+        m_doors.insert(key, door);
+        m_stateCounts[state] += 1;
+        m_totalEvents += live ? 1 : 0;
+        m_summaryDirty = true;
+        return true;
+    }
+    
+    Door &door = it.value();
+    if (live) {
+        ++door.eventCount;
+        ++m_totalEvents;
+    } else if (door.lastEventAt > eventTime) {
+        // 同步阶段收到的旧状态不覆盖已知的更新状态
+        return false;
+    }
+    
+    door.lastEventAt = eventTime;
+    if (event.hasMessage) {
+        door.lastMessage = event.message;
+    }
+    if (door.state == state) {
+        return false;
+    }
+    
+    moveState(door.state, state);
+    door.state = state;
+    door.stateSince = eventTime;
+    return true;
+}
+
+void DoorStateTable::moveState(const QString &from, const QString &to)
+{
+    QHash<QString, int>::iterator it = m_stateCounts.find(from);
+    if (it != m_stateCounts.end() && --it.value() <= 0) {
+        m_stateCounts.erase(it);
+    }
+    m_stateCounts[to] += 1;
+    m_summaryDirty = true;
+}
+
+void DoorStateTable::clear()
+{
+    m_doors.clear();
+    m_stateCounts.clear();
+    m_totalEvents = 0;
+    m_summaryDirty = true;
+}
+
+const DoorStateTable::Door *DoorStateTable::find(const QString &doorId) const
+{
+    QHash<QString, Door>::const_iterator it = m_doors.constFind(doorId);
+    return it == m_doors.constEnd() ? nullptr : &it.value();
+}
+
+int DoorStateTable::doorCount() const
+{
+    return m_doors.size();
+}
+
+quint64 DoorStateTable::totalEvents() const
+{
+    return m_totalEvents;
+}
+
+QString DoorStateTable::summary() const
+{
+    if (!m_summaryDirty) {
+        return m_summary;
+    }
+    
+    // 只遍历状态计数，门再多也只有几种状态
+    QList<QPair<int, QString> > counts;
+    for (QHash<QString, int>::const_iterator it = m_stateCounts.constBegin(); it != m_stateCounts.constEnd(); ++it) {
+        counts.append(qMakePair(it.value(), it.key()));
+    }
+    std::sort(counts.begin(), counts.end(), [](const QPair<int, QString> &a, const QPair<int, QString> &b) {
+        return a.first != b.first ? a.first > b.first : a.second < b.second;
+    });
+    
+    QStringList parts;
+    for (int i = 0; i < counts.size() && i < MaxSummaryStates; ++i) {
+        parts.append(QString("%1 %2").arg(stateName(counts.at(i).second)).arg(counts.at(i).first));
+    }
+    if (counts.size() > MaxSummaryStates) {
+        parts.append("…");
+    }
+    
+    m_summary = parts.isEmpty() ? QString("暂无门状态")
+                                : QString("%1 扇门: %2").arg(m_doors.size()).arg(parts.join("，"));
+    m_summaryDirty = false;
+    return m_summary;
+}
+
+QList<const DoorStateTable::Door*> DoorStateTable::recentlyChanged(int count) const
+{
+    QList<const Door*> doors;
+    doors.reserve(m_doors.size());
+    for (QHash<QString, Door>::const_iterator it = m_doors.constBegin(); it != m_doors.constEnd(); ++it) {
+        doors.append(&it.value());
+    }
+    
+    // 只需要前 count 个，部分排序即可
+    count = qBound(0, count, doors.size());
+    std::partial_sort(doors.begin(), doors.begin() + count, doors.end(), [](const Door *a, const Door *b) {
+        return a->stateSince > b->stateSince;
+    });
+    return doors.mid(0, count);
+}
+
+QString DoorStateTable::stateName(const QString &state)
+{
+    if (state == QLatin1String("door_button_pressed")) {
+        return "按下";
+    }
+    if (state == QLatin1String("door_button_released")) {
+        return "松开";
+    }
+    return state;
+}
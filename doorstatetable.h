@@ -0,0 +1,54 @@
+#ifndef DOORSTATETABLE_H
+#define DOORSTATETABLE_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QDateTime>
+#include "doorevent.h"
+
+// 门状态表：按门编号（没有 door_id 时按 MQTT 主题）记录当前状态、最近变化时间、事件计数和最近一条消息
+// 每个事件按门编号哈希查找后原地更新，复杂度 O(1)；
+// 各状态的门数同步增减，托盘摘要只在计数变化时按状态数（而不是门数）重新生成
+class DoorStateTable
+{
+public:
+    struct Door
+    {
+        QString doorId;         // door_id，缺失时为消息主题
+        QString state;          // 最近一次事件的类型，例如 door_button_pressed
+        QString lastMessage;
+        QDateTime stateSince;   // 进入当前状态的时间
+        QDateTime lastEventAt;  // 最近一次事件的时间
+        quint64 eventCount;     // 实时事件数，同步阶段的状态不计入
+    };
+    
+    DoorStateTable();
+    
+    // live 为 false 表示同步阶段的状态：不计入事件数，也不覆盖更新的状态
+    // 返回 true 表示门数或某个状态的门数发生了变化，摘要需要更新
+    bool update(const DoorEvent &event, bool live);
+    void clear();
+    
+    const Door *find(const QString &doorId) const;
+    int doorCount() const;
+    quint64 totalEvents() const;
+    
+    // 形如 "12 扇门: 按下 2，松开 10"，计数未变化时直接返回缓存
+    QString summary() const;
+    // 最近发生状态变化的门，最新的在前
+    QList<const Door*> recentlyChanged(int count) const;
+    
+    static QString stateName(const QString &state);
+
+private:
+    void moveState(const QString &from, const QString &to);
+    
+    QHash<QString, Door> m_doors;
+    QHash<QString, int> m_stateCounts;  // 状态 -> 处于该状态的门数
+    quint64 m_totalEvents;
+    mutable QString m_summary;
+    mutable bool m_summaryDirty;
+};
+
+#endif // DOORSTATETABLE_H
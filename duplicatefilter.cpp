@@ -0,0 +1,78 @@
+#include "duplicatefilter.h"
+
+DuplicateFilter::DuplicateFilter(int capacity, int windowMs)
+    : m_capacity(qMax(0, capacity))
+    , m_windowMs(qMax(0, windowMs))
+{
+    m_clock.start();
+}
+
+void DuplicateFilter::setCapacity(int capacity)
+{
+    m_capacity = qMax(0, capacity);
+    evict();
+}
+
+int DuplicateFilter::capacity() const
+{
+    return m_capacity;
+}
+
+void DuplicateFilter::setWindow(int windowMs)
+{
+    m_windowMs = qMax(0, windowMs);
+}
+
+int DuplicateFilter::window() const
+{
+    return m_windowMs;
+}
+
+quint64 DuplicateFilter::fingerprint(const QString &topic, const QByteArray &payload)
+{
+    // 用两个不同种子的哈希拼成 64 位指纹，降低碰撞概率
+    uint topicHash = qHash(topic);
+    quint64 high = qHash(payload, topicHash);
+    quint64 low = qHash(payload, ~topicHash);
+    return (high << 32) | low;
+}
+
+bool DuplicateFilter::isDuplicate(const QString &topic, const QByteArray &payload, bool redelivery)
+{
+    if (m_capacity == 0) {
+        return false;
+    }
+    
+    qint64 now = m_clock.elapsed();
+    quint64 key = fingerprint(topic, payload);
+    QHash<quint64, std::list<Entry>::iterator>::iterator it = m_entries.find(key);
+    if (it != m_entries.end()) {
+        bool recent = now - it.value()->seenAtMs <= m_windowMs;
+        // 移到队首，刷新最近见过的时间
+        it.value()->seenAtMs = now;
+        m_order.splice(m_order.begin(), m_order, it.value());
+        return redelivery && recent;
+    }
+    
+    Entry entry;
+    entry.key = key;
+    entry.seenAtMs = now;
+    m_order.push_front(entry);
+    m_entries.insert(key, m_order.begin());
+    evict();
+    return false;
+}
+
+void DuplicateFilter::clear()
+{
+    m_order.clear();
+    m_entries.clear();
+}
+
+void DuplicateFilter::evict()
+{
+    while (m_entries.size() > m_capacity) {
+        m_entries.remove(m_order.back().key);
+        m_order.pop_back();
+    }
+}
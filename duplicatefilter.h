@@ -0,0 +1,46 @@
+#ifndef DUPLICATEFILTER_H
+#define DUPLICATEFILTER_H
+
+#include <QHash>
+#include <QByteArray>
+#include <QString>
+#include <QElapsedTimer>
+#include <list>
+
+// 重复消息过滤：记录最近见过的消息指纹，容量满时淘汰最久未见的条目（LRU），超过有效期的指纹不再算见过
+// QoS 1 下服务端可能重发同一条消息，持久会话重连后也可能补发已处理过的事件；
+// 只有重发的消息才会被判为重复，正常收到的相同内容（例如连按两次门铃）照常处理
+class DuplicateFilter
+{
+public:
+    explicit DuplicateFilter(int capacity = 1024, int windowMs = 60000);
+    
+    // 容量为 0 时关闭过滤
+    void setCapacity(int capacity);
+    int capacity() const;
+    void setWindow(int windowMs);
+    int window() const;
+    
+    // 记录该消息；redelivery 为 true 且有效期内见过时返回 true
+    bool isDuplicate(const QString &topic, const QByteArray &payload, bool redelivery);
+    void clear();
+    
+    static quint64 fingerprint(const QString &topic, const QByteArray &payload);
+
+private:
+    struct Entry
+    {
+        quint64 key;
+        qint64 seenAtMs;
+    };
+    
+    void evict();
+    
+    int m_capacity;
+    int m_windowMs;
+    QElapsedTimer m_clock;
+    std::list<Entry> m_order;  // 队首为最近见过的指纹
+    QHash<quint64, std::list<Entry>::iterator> m_entries;
+};
+
+#endif // DUPLICATEFILTER_H
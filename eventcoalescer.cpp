@@ -0,0 +1,165 @@
+#include "eventcoalescer.h"
+#include "logger.h"
+
+EventCoalescer::EventCoalescer(QObject *parent)
+    : QObject(parent)
+    , m_enabled(true)
+    , m_pairWindowMs(1000)
+    , m_burstThreshold(5)
+    , m_burstWindowMs(5000)
+    , m_inBurst(false)
+    , m_burstStart(0)
+    , m_burstEvents(0)
+    , m_burstTimer(new QTimer(this))
+    , m_receivedCount(0)
+    , m_coalescedCount(0)
+    , m_emittedCount(0)
+    , m_digestCount(0)
+{
+    m_clock.start();
+    m_burstTimer->setSingleShot(true);
+    connect(m_burstTimer, &QTimer::timeout, this, [this]() {
+        onBurstTimeout();
+    });
+}
+
+void EventCoalescer::setEnabled(bool enabled)
+{
+    m_enabled = enabled;
+}
+
+void EventCoalescer::setPairWindow(int windowMs)
+{
+    m_pairWindowMs = qMax(0, windowMs);
+}
+
+void EventCoalescer::setBurstThreshold(int events)
+{
+    m_burstThreshold = qMax(2, events);
+}
+
+void EventCoalescer::setBurstWindow(int windowMs)
+{
+    m_burstWindowMs = qMax(100, windowMs);
+}
+
+void EventCoalescer::setEventPriorities(const QHash<QString, int> &priorities)
+{
+    m_priorities = priorities;
+}
+
+void EventCoalescer::addEvent(const DoorEvent &received)
+{
+    m_receivedCount.fetchAndAddRelaxed(1);
+    
+    DoorEvent event = received;
+    if (!event.hasPriority) {
+        event.priority = DoorEvent::Priority(m_priorities.value(event.event, DoorEvent::Normal));
+    }
+    
+    // 高优先级事件不能被并入按下通知或汇总通知，否则到不了调度器，也抢占不了屏幕上的通知
+    if (!m_enabled || event.priority >= DoorEvent::High) {
+        m_emittedCount.fetchAndAddRelaxed(1);
+        emit eventReady(event);
+        return;
+    }
+    
+    qint64 now = m_clock.elapsed();
+    const QString &door = event.doorId;
+    
+    // 按下/松开配对：窗口内同一扇门的松开事件并入之前的按下通知
+    if (event.event == QLatin1String("door_button_released")) {
+        QHash<QString, qint64>::iterator it = m_lastPressed.find(door);
+        if (it != m_lastPressed.end() && now - it.value() <= m_pairWindowMs) {
+            m_lastPressed.erase(it);
+            m_coalescedCount.fetchAndAddRelaxed(1);
+            LOG_DEBUG_CAT(Logger::Ui, QString("松开事件已与按下事件合并，门: %1").arg(door));
+            return;
+        }
+    } else if (event.event == QLatin1String("door_button_pressed")) {
+        m_lastPressed.insert(door, now);
+    }
+    
+    // 突发检测：窗口内事件数达到阈值后进入汇总模式
+    // 只需判断窗口内是否达到阈值，保留最近 threshold 个时间点即可，内存不随速率增长
+    m_recentEvents.enqueue(now);
+    while (m_recentEvents.size() > m_burstThreshold) {
+        m_recentEvents.dequeue();
+    }
+    pruneRecentEvents(now);
+    
+    if (!m_inBurst && m_recentEvents.size() >= m_burstThreshold) {
+        m_inBurst = true;
+        m_burstStart = now;
+        m_burstEvents = 0;
+        m_burstDoors.clear();
+        m_burstTimer->start(m_burstWindowMs);
+        LOG_WARNING_CAT(Logger::Ui, QString("%1 ms 内收到 %2 个门禁事件，进入汇总模式")
+                        .arg(m_burstWindowMs)
+                        .arg(m_recentEvents.size()));
+    }
+    
+    if (m_inBurst) {
+        ++m_burstEvents;
+        m_burstDoors.insert(door);
+        m_coalescedCount.fetchAndAddRelaxed(1);
+        return;
+    }
+    
+    m_emittedCount.fetchAndAddRelaxed(1);
+    emit eventReady(event);
+}
+
+void EventCoalescer::onBurstTimeout()
+{
+    qint64 now = m_clock.elapsed();
+    
+    if (m_burstEvents > 0) {
+        m_digestCount.fetchAndAddRelaxed(1);
+        emit digestReady(m_burstEvents, m_burstDoors.size(), int(now - m_burstStart));
+    }
+    
+    // 仍处于突发中则继续汇总下一个窗口，否则恢复逐条通知
+    pruneRecentEvents(now);
+    if (m_recentEvents.size() >= m_burstThreshold) {
+        m_burstStart = now;
+        m_burstEvents = 0;
+        m_burstDoors.clear();
+        m_burstTimer->start(m_burstWindowMs);
+    } else {
+        m_inBurst = false;
+        LOG_INFO_CAT(Logger::Ui, "门禁事件恢复正常速率，退出汇总模式");
+    }
+}
+
+void EventCoalescer::pruneRecentEvents(qint64 now)
+{
+    while (!m_recentEvents.isEmpty() && now - m_recentEvents.head() > m_burstWindowMs) {
+        m_recentEvents.dequeue();
+    }
+}
+
+bool EventCoalescer::isInBurst() const
+{
+    return m_inBurst;
+}
+
+quint64 EventCoalescer::receivedCount() const
+{
+    return m_receivedCount.load();
+}
+
+quint64 EventCoalescer::coalescedCount() const
+{
+    return m_coalescedCount.load();
+}
+
+quint64 EventCoalescer::emittedCount() const
+{
+    return m_emittedCount.load();
+}
+
+quint64 EventCoalescer::digestCount() const
+{
+    return m_digestCount.load();
+}
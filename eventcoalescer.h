@@ -0,0 +1,71 @@
+#ifndef EVENTCOALESCER_H
+#define EVENTCOALESCER_H
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QQueue>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QAtomicInteger>
+#include "doorevent.h"
+
+// 事件合并：按门配对按下/松开事件，突发时把大量事件合并为一条汇总通知
+// 进入合并之前先确定优先级，High/Critical 事件不参与配对和汇总，直接逐条发出
+class EventCoalescer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit EventCoalescer(QObject *parent = nullptr);
+    
+    void setEnabled(bool enabled);
+    void setPairWindow(int windowMs);
+    void setBurstThreshold(int events);
+    void setBurstWindow(int windowMs);
+    // 事件类型 -> DoorEvent::Priority，负载中没有 priority 字段时使用，未配置的类型为 Normal
+    void setEventPriorities(const QHash<QString, int> &priorities);
+    
+    // 发出的事件 priority 已确定（负载中的字段优先，其次按事件类型配置）
+    void addEvent(const DoorEvent &event);
+    
+    bool isInBurst() const;
+    quint64 receivedCount() const;
+    quint64 coalescedCount() const;
+    quint64 emittedCount() const;
+    quint64 digestCount() const;
+
+signals:
+    void eventReady(const DoorEvent &event);
+    void digestReady(int eventCount, int doorCount, int windowMs);
+
+private slots:
+    void onBurstTimeout();
+
+private:
+    void pruneRecentEvents(qint64 now);
+    
+    bool m_enabled;
+    int m_pairWindowMs;
+    int m_burstThreshold;
+    int m_burstWindowMs;
+    QHash<QString, int> m_priorities;
+    
+    QElapsedTimer m_clock;
+    QHash<QString, qint64> m_lastPressed; // 门编号 -> 最近一次按下事件的时间
+    QQueue<qint64> m_recentEvents;        // 突发窗口内的事件时间
+    
+    bool m_inBurst;
+    qint64 m_burstStart;
+    int m_burstEvents;
+    QSet<QString> m_burstDoors;
+    QTimer *m_burstTimer;
+    
+    // 计数器用原子类型，监控接口可以在其他线程读取
+    QAtomicInteger<quint64> m_receivedCount;
+    QAtomicInteger<quint64> m_coalescedCount;
+    QAtomicInteger<quint64> m_emittedCount;
+    QAtomicInteger<quint64> m_digestCount;
+};
+
+#endif // EVENTCOALESCER_H
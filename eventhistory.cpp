@@ -0,0 +1,362 @@
+#include "eventhistory.h"
+#include "logger.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <cstring>
+
+namespace {
+
+const quint32 HistoryMagic = 0x48455344;  // "DSEH"
+const quint32 HistoryVersion = 1;
+const int IndexStride = 64;               // 每 64 条记录一个时间索引项
+const int MaxShortField = 64;             // 事件类型和门编号的最大字符数
+const int MaxMessage = 256;               // 消息的最大字符数
+
+} // namespace
+
+// 文件头，64 字节
+struct EventHistory::Header
+{
+    quint32 magic;
+    quint32 version;
+    quint32 recordCapacity;
+    quint32 indexCapacity;
+    quint64 heapSize;
+    quint64 recordCount;  // 累计写入的记录数，也是下一条记录的序号
+    quint64 heapHead;     // 累计写入堆的字节数，也是下一段字符串的位置
+    quint32 indexStride;
+    quint32 reserved;
+    quint64 reserved2[2];
+};
+
+// 定长事件记录，40 字节；字符串保存在堆中，按 事件类型 | 门编号 | 消息 连续存放
+struct EventHistory::Record
+{
+    qint64 timeMs;
+    qint64 brokerTimeMs;
+    quint64 sequence;     // 写入时的序号，用于判断槽位是否已被覆盖
+    quint64 heapOffset;   // 堆中的绝对位置（未取模）
+    quint16 eventLength;
+    quint16 doorIdLength;
+    quint16 messageLength;
+    quint16 reserved;
+};
+
+// 稀疏时间索引项，16 字节
+struct EventHistory::IndexEntry
+{
+    qint64 timeMs;
+    quint64 sequence;
+};
+
+EventHistory::EventHistory()
+    : m_map(nullptr)
+    , m_header(nullptr)
+    , m_records(nullptr)
+    , m_index(nullptr)
+    , m_heap(nullptr)
+{
+}
+
+EventHistory::~EventHistory()
+{
+    close();
+}
+
+bool EventHistory::open(const QString &path, int recordCapacity, int heapBytes)
+{
+    close();
+    recordCapacity = qMax(IndexStride, recordCapacity);
+    heapBytes = qMax(4096, heapBytes);
+    
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadWrite)) {
+        LOG_ERROR(QString("无法打开事件历史文件: %1 (%2)").arg(path).arg(m_file.errorString()));
+        return false;
+    }
+    
+    if (!mapFile(recordCapacity, heapBytes)) {
+        close();
+        return false;
+    }
+    
+    if (!isValid()
+            || m_header->recordCapacity != quint32(recordCapacity)
+            || m_header->heapSize != quint64(heapBytes)) {
+        LOG_INFO(QString("创建事件历史文件: %1 (%2 条记录)").arg(path).arg(recordCapacity));
+        initialize(recordCapacity, heapBytes);
+    } else {
+        LOG_INFO(QString("已加载事件历史文件: %1 (%2 条事件)").arg(path).arg(size()));
+    }
+    return true;
+}
+
+bool EventHistory::mapFile(int recordCapacity, int heapBytes)
+{
+    int indexCapacity = recordCapacity / IndexStride + 2;
+    qint64 fileSize = qint64(sizeof(Header))
+            + qint64(recordCapacity) * qint64(sizeof(Record))
+            + qint64(indexCapacity) * qint64(sizeof(IndexEntry))
+            + heapBytes;
+    
+    // 大小不一致说明文件是旧格式或损坏，调整大小后由 initialize() 重建
+    if (m_file.size() != fileSize) {
+        if (!m_file.resize(fileSize)) {
+            LOG_ERROR(QString("无法调整事件历史文件大小: %1").arg(m_file.errorString()));
+            return false;
+        }
+    }
+    
+    m_map = m_file.map(0, fileSize);
+    if (!m_map) {
+        LOG_ERROR(QString("无法映射事件历史文件: %1").arg(m_file.errorString()));
+        return false;
+    }
+    m_header = reinterpret_cast<Header*>(m_map);
+    m_records = reinterpret_cast<Record*>(m_map + sizeof(Header));
+    m_index = reinterpret_cast<IndexEntry*>(m_records + recordCapacity);
+    m_heap = reinterpret_cast<uchar*>(m_index + indexCapacity);
+    
+    if (m_header->magic == HistoryMagic && m_header->indexCapacity != quint32(indexCapacity)) {
+        // 头部与实际布局不符，强制重建
+        m_header->magic = 0;
+    }
+    return true;
+}
+
+void EventHistory::initialize(int recordCapacity, int heapBytes)
+{
+    std::memset(m_map, 0, size_t(m_file.size()));
+    m_header->version = HistoryVersion;
+    m_header->recordCapacity = quint32(recordCapacity);
+    m_header->indexCapacity = quint32(recordCapacity / IndexStride + 2);
+    m_header->heapSize = quint64(heapBytes);
+    m_header->recordCount = 0;
+    m_header->heapHead = 0;
+    m_header->indexStride = IndexStride;
+    // 最后写魔数，初始化中途退出时下次会重新初始化
+    m_header->magic = HistoryMagic;
+}
+
+bool EventHistory::isValid() const
+{
+    return m_header
+            && m_header->magic == HistoryMagic
+            && m_header->version == HistoryVersion
+            && m_header->indexStride == quint32(IndexStride)
+            && m_header->recordCapacity > 0;
+}
+
+void EventHistory::close()
+{
+    if (m_map) {
+        m_file.unmap(m_map);
+    }
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+    m_map = nullptr;
+    m_header = nullptr;
+    m_records = nullptr;
+    m_index = nullptr;
+    m_heap = nullptr;
+}
+
+bool EventHistory::isOpen() const
+{
+    return m_map != nullptr;
+}
+
+quint64 EventHistory::totalAppended() const
+{
+    return m_header ? m_header->recordCount : 0;
+}
+
+int EventHistory::size() const
+{
+    return m_header ? int(m_header->recordCount - oldestSequence()) : 0;
+}
+
+quint64 EventHistory::oldestSequence() const
+{
+    quint64 capacity = m_header->recordCapacity;
+    return m_header->recordCount > capacity ? m_header->recordCount - capacity : 0;
+}
+
+EventHistory::Record *EventHistory::recordAt(quint64 sequence) const
+{
+    return m_records + (sequence % m_header->recordCapacity);
+}
+
+EventHistory::IndexEntry *EventHistory::indexAt(quint64 slot) const
+{
+    return m_index + (slot % m_header->indexCapacity);
+}
+
+void EventHistory::writeHeap(quint64 position, const QByteArray &data)
+{
+    // 跨越堆末尾时分两段写入
+    quint64 heapSize = m_header->heapSize;
+    quint64 start = position % heapSize;
+    quint64 first = qMin<quint64>(quint64(data.size()), heapSize - start);
+    std::memcpy(m_heap + start, data.constData(), size_t(first));
+    if (first < quint64(data.size())) {
+        std::memcpy(m_heap, data.constData() + first, size_t(data.size() - first));
+    }
+}
+
+QByteArray EventHistory::readHeap(quint64 position, int length) const
+{
+    QByteArray data(length, Qt::Uninitialized);
+    quint64 heapSize = m_header->heapSize;
+    quint64 start = position % heapSize;
+    quint64 first = qMin<quint64>(quint64(length), heapSize - start);
+    std::memcpy(data.data(), m_heap + start, size_t(first));
+    if (first < quint64(length)) {
+        std::memcpy(data.data() + first, m_heap, size_t(length - first));
+    }
+    return data;
+}
+
+void EventHistory::append(const DoorEvent &event)
+{
+    if (!m_map) {
+        return;
+    }
+    
+    QByteArray eventType = event.event.left(MaxShortField).toUtf8();
+    QByteArray doorId = event.doorId.left(MaxShortField).toUtf8();
+    QByteArray message = event.message.left(MaxMessage).toUtf8();
+    
+    quint64 sequence = m_header->recordCount;
+    quint64 heapOffset = m_header->heapHead;
+    
+    // 记录时间保证单调不减，时间段查询才能使用二分查找
+    qint64 timeMs = event.receivedAtMs > 0 ? event.receivedAtMs : QDateTime::currentMSecsSinceEpoch();
+    if (sequence > 0) {
+        timeMs = qMax(timeMs, recordAt(sequence - 1)->timeMs);
+    }
+    
+    writeHeap(heapOffset, eventType);
+    writeHeap(heapOffset + eventType.size(), doorId);
+    writeHeap(heapOffset + eventType.size() + doorId.size(), message);
+    
+    Record *record = recordAt(sequence);
+    record->timeMs = timeMs;
+    record->brokerTimeMs = event.dateTime.isValid() ? event.dateTime.toMSecsSinceEpoch() : 0;
+    record->sequence = sequence;
+    record->heapOffset = heapOffset;
+    record->eventLength = quint16(eventType.size());
+    record->doorIdLength = quint16(doorId.size());
+    record->messageLength = quint16(message.size());
+    record->reserved = 0;
+    
+    if (sequence % IndexStride == 0) {
+        IndexEntry *entry = indexAt(sequence / IndexStride);
+        entry->timeMs = timeMs;
+        entry->sequence = sequence;
+    }
+    
+    // 最后推进计数，写到一半崩溃时不会暴露不完整的记录
+    m_header->heapHead = heapOffset + eventType.size() + doorId.size() + message.size();
+    m_header->recordCount = sequence + 1;
+}
+
+bool EventHistory::readEntry(quint64 sequence, Entry *entry) const
+{
+    const Record *record = recordAt(sequence);
+    if (record->sequence != sequence) {
+        return false;
+    }
+    
+    // 字符串已被后来的事件覆盖
+    int totalLength = record->eventLength + record->doorIdLength + record->messageLength;
+    if (m_header->heapHead - record->heapOffset > m_header->heapSize
+            || totalLength > int(m_header->heapSize)) {
+        return false;
+    }
+    
+    QByteArray strings = readHeap(record->heapOffset, totalLength);
+    entry->timeMs = record->timeMs;
+    entry->brokerTimeMs = record->brokerTimeMs;
+    entry->eventType = QString::fromUtf8(strings.constData(), record->eventLength);
+    entry->doorId = QString::fromUtf8(strings.constData() + record->eventLength, record->doorIdLength);
+    entry->message = QString::fromUtf8(strings.constData() + record->eventLength + record->doorIdLength,
+                                       record->messageLength);
+    return true;
+}
+
+QList<EventHistory::Entry> EventHistory::recent(int count) const
+{
+    QList<Entry> entries;
+    if (!m_map) {
+        return entries;
+    }
+    
+    quint64 oldest = oldestSequence();
+    for (quint64 sequence = m_header->recordCount; sequence > oldest && entries.size() < count; --sequence) {
+        Entry entry;
+        if (!readEntry(sequence - 1, &entry)) {
+            break;
+        }
+        entries.append(entry);
+    }
+    return entries;
+}
+
+quint64 EventHistory::findFirstAtOrAfter(qint64 timeMs) const
+{
+    quint64 oldest = oldestSequence();
+    quint64 newest = m_header->recordCount;
+    if (newest == oldest) {
+        return newest;
+    }
+    
+    // 在有效的索引项中二分查找最后一个时间早于 timeMs 的项
+    quint64 low = (oldest + IndexStride - 1) / IndexStride;
+    quint64 high = (newest - 1) / IndexStride + 1;
+    quint64 start = oldest;
+    while (low < high) {
+        quint64 mid = low + (high - low) / 2;
+        const IndexEntry *entry = indexAt(mid);
+        if (entry->sequence != mid * IndexStride) {
+            break;
+        }
+        if (entry->timeMs < timeMs) {
+            start = qMax(start, entry->sequence);
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    
+    // 索引之间最多线性扫描 IndexStride 条
+    for (quint64 sequence = start; sequence < newest; ++sequence) {
+        if (recordAt(sequence)->timeMs >= timeMs) {
+            return sequence;
+        }
+    }
+    return newest;
+}
+
+QList<EventHistory::Entry> EventHistory::between(qint64 fromMs, qint64 toMs, int limit) const
+{
+    QList<Entry> entries;
+    if (!m_map || fromMs > toMs) {
+        return entries;
+    }
+    
+    quint64 newest = m_header->recordCount;
+    for (quint64 sequence = findFirstAtOrAfter(fromMs); sequence < newest && entries.size() < limit; ++sequence) {
+        if (recordAt(sequence)->timeMs > toMs) {
+            break;
+        }
+        Entry entry;
+        if (readEntry(sequence, &entry)) {
+            entries.append(entry);
+        }
+    }
+    return entries;
+}
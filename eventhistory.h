@@ -0,0 +1,67 @@
+#ifndef EVENTHISTORY_H
+#define EVENTHISTORY_H
+
+#include <QString>
+#include <QList>
+#include <QFile>
+#include "doorevent.h"
+
+// 事件历史：固定大小、内存映射的环形文件，重启后仍然可以查询
+// 文件由四部分组成：文件头 | 定长事件记录环 | 稀疏时间索引环 | 字符串堆环
+// 追加一条事件只写映射内存，复杂度 O(1)；记录满后覆盖最早的事件
+class EventHistory
+{
+public:
+    struct Entry
+    {
+        qint64 timeMs;        // 记录时的本机时间（毫秒时间戳），单调递增，用于时间查询
+        qint64 brokerTimeMs;  // 服务端时间戳，缺失时为 0
+        QString eventType;
+        QString doorId;
+        QString message;
+    };
+    
+    EventHistory();
+    ~EventHistory();
+    
+    // 打开或创建历史文件；已有文件的容量与参数不一致时重新创建
+    bool open(const QString &path, int recordCapacity, int heapBytes);
+    void close();
+    bool isOpen() const;
+    
+    void append(const DoorEvent &event);
+    
+    // 最近 count 条事件，最新的在前
+    QList<Entry> recent(int count) const;
+    // [fromMs, toMs] 时间段内的事件，按时间顺序，最多 limit 条
+    QList<Entry> between(qint64 fromMs, qint64 toMs, int limit = 1000) const;
+    
+    quint64 totalAppended() const;
+    int size() const;  // 当前可查询的事件数
+
+private:
+    struct Header;
+    struct Record;
+    struct IndexEntry;
+    
+    bool mapFile(int recordCapacity, int heapBytes);
+    void initialize(int recordCapacity, int heapBytes);
+    bool isValid() const;
+    quint64 oldestSequence() const;
+    
+    Record *recordAt(quint64 sequence) const;
+    IndexEntry *indexAt(quint64 slot) const;
+    void writeHeap(quint64 position, const QByteArray &data);
+    QByteArray readHeap(quint64 position, int length) const;
+    bool readEntry(quint64 sequence, Entry *entry) const;
+    quint64 findFirstAtOrAfter(qint64 timeMs) const;
+    
+    QFile m_file;
+    uchar *m_map;
+    Header *m_header;
+    Record *m_records;
+    IndexEntry *m_index;
+    uchar *m_heap;
+};
+
+#endif // EVENTHISTORY_H
@@ -0,0 +1,138 @@
+#include "headlessnotifier.h"
+#include "logger.h"
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QJsonObject>
+#include <QJsonDocument>
+#include <QDateTime>
+#include <cstdio>
+
+namespace {
+// 单个订阅者未读走的数据上限，超过后断开，不读数据的订阅者不会让内存无限增长
+const qint64 MaxPendingBytes = 1024 * 1024;
+}
+
+HeadlessNotifier::HeadlessNotifier(QObject *parent)
+    : QObject(parent)
+    , m_target(LogTarget)
+    , m_server(nullptr)
+{
+}
+
+HeadlessNotifier::~HeadlessNotifier()
+{
+    stopServer();
+}
+
+HeadlessNotifier::Target HeadlessNotifier::targetFromString(const QString &name)
+{
+    QString lower = name.trimmed().toLower();
+    if (lower == "stdout") {
+        return StdoutTarget;
+    }
+    if (lower == "socket") {
+        return SocketTarget;
+    }
+    return LogTarget;
+}
+
+void HeadlessNotifier::setTarget(Target target, const QString &socketName)
+{
+    if (target == SocketTarget) {
+        if (!m_server || m_server->serverName() != socketName) {
+            stopServer();
+            startServer(socketName);
+        }
+    } else {
+        stopServer();
+    }
+    m_target = target;
+}
+
+HeadlessNotifier::Target HeadlessNotifier::target() const
+{
+    return m_target;
+}
+
+int HeadlessNotifier::clientCount() const
+{
+    return m_clients.size();
+}
+
+void HeadlessNotifier::startServer(const QString &socketName)
+{
+    m_server = new QLocalServer(this);
+    // 上次异常退出可能留下同名套接字文件
+    QLocalServer::removeServer(socketName);
+    if (!m_server->listen(socketName)) {
+        LOG_ERROR_CAT(Logger::Ui, QString("本地套接字监听失败: %1 (%2)").arg(socketName).arg(m_server->errorString()));
+        return;
+    }
+    
+    connect(m_server, &QLocalServer::newConnection, this, [this]() {
+        while (QLocalSocket *client = m_server->nextPendingConnection()) {
+            m_clients.append(client);
+            connect(client, &QLocalSocket::disconnected, this, [this, client]() {
+                m_clients.removeOne(client);
+                client->deleteLater();
+            });
+            LOG_INFO_CAT(Logger::Ui, QString("通知订阅者已连接，当前 %1 个").arg(m_clients.size()));
+        }
+    });
+    
+    LOG_INFO_CAT(Logger::Ui, QString("通知通过本地套接字推送: %1").arg(m_server->fullServerName()));
+}
+
+void HeadlessNotifier::stopServer()
+{
+    if (!m_server) {
+        return;
+    }
+    for (QLocalSocket *client : m_clients) {
+        client->disconnect(this);
+        client->abort();
+        client->deleteLater();
+    }
+    m_clients.clear();
+    m_server->close();
+    delete m_server;
+    m_server = nullptr;
+}
+
+void HeadlessNotifier::notify(const QString &title, const QString &message, const QString &eventType)
+{
+    if (m_target == LogTarget) {
+        LOG_INFO_CAT(Logger::Ui, QString("通知: %1 - %2").arg(title).arg(message));
+        return;
+    }
+    
+    QJsonObject object;
+    object.insert("time", QDateTime::currentDateTime().toString(Qt::ISODateWithMs));
+    object.insert("event", eventType);
+    object.insert("title", title);
+    object.insert("message", message);
+    QByteArray line = QJsonDocument(object).toJson(QJsonDocument::Compact);
+    line.append('\n');
+    
+    if (m_target == StdoutTarget) {
+        fwrite(line.constData(), 1, size_t(line.size()), stdout);
+        fflush(stdout);
+        return;
+    }
+    
+    // 遍历副本：断开订阅者时会从 m_clients 中移除
+    const QList<QLocalSocket*> clients = m_clients;
+    for (QLocalSocket *client : clients) {
+        if (client->bytesToWrite() + line.size() > MaxPendingBytes) {
+            m_clients.removeOne(client);
+            client->disconnect(this);
+            client->abort();
+            client->deleteLater();
+            LOG_WARNING_CAT(Logger::Ui, QString("通知订阅者积压超过 %1 KB 未读取，已断开，当前 %2 个")
+                            .arg(MaxPendingBytes / 1024)
+                            .arg(m_clients.size()));
+            continue;
+        }
+        client->write(line);
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef HEADLESSNOTIFIER_H
+#define HEADLESSNOTIFIER_H
+
+#include <QObject>
+#include <QList>
+
+class QLocalServer;
+class QLocalSocket;
+
+// 无界面模式下的通知输出：写日志、写标准输出，或通过本地套接字推送给其他进程
+// 每条通知是一行 JSON：{"time":...,"event":...,"title":...,"message":...}
+// 套接字订阅者积压超过 1 MB 未读取时断开
+class HeadlessNotifier : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Target {
+        LogTarget,
+        StdoutTarget,
+        SocketTarget
+    };
+    
+    explicit HeadlessNotifier(QObject *parent = nullptr);
+    ~HeadlessNotifier();
+    
+    // socketName 只在 SocketTarget 时使用
+    void setTarget(Target target, const QString &socketName = QString());
+    Target target() const;
+    
+    void notify(const QString &title, const QString &message, const QString &eventType);
+    
+    int clientCount() const;
+    
+    static Target targetFromString(const QString &name);
+
+private:
+    void startServer(const QString &socketName);
+    void stopServer();
+    
+    Target m_target;
+    QLocalServer *m_server;
+    QList<QLocalSocket*> m_clients;
+};
+
+#endif // HEADLESSNOTIFIER_H
@@ -0,0 +1,111 @@
+#include "inboundbuffer.h"
+
+InboundBuffer::InboundBuffer(int capacity, int highWatermark, int lowWatermark)
+    : m_capacity(1)
+    , m_highWatermark(1)
+    , m_lowWatermark(0)
+    , m_policy(DropOldest)
+    , m_sampleEvery(10)
+    , m_sampleCounter(0)
+    , m_overloaded(false)
+{
+    setLimits(capacity, highWatermark, lowWatermark);
+}
+
+void InboundBuffer::setLimits(int capacity, int highWatermark, int lowWatermark)
+{
+    m_capacity = qMax(2, capacity);
+    m_highWatermark = qBound(2, highWatermark, m_capacity);
+    m_lowWatermark = qBound(1, lowWatermark, m_highWatermark - 1);
+    
+    // 缩小容量时丢弃最早的消息
+    while (m_queue.size() > m_capacity) {
+        m_queue.dequeue();
+    }
+    updateOverload();
+}
+
+void InboundBuffer::setPolicy(Policy policy, int sampleEvery)
+{
+    m_policy = policy;
+    m_sampleEvery = qMax(1, sampleEvery);
+    m_sampleCounter = 0;
+}
+
+InboundBuffer::Policy InboundBuffer::policyFromString(const QString &name)
+{
+    return name.trimmed().toLower() == "sample" ? Sample : DropOldest;
+}
+
+int InboundBuffer::push(const Message &message)
+{
+    if (m_policy == Sample) {
+        // 过载期间只保留每 N 条中的第 1 条，恢复后计数重新开始
+        if (m_overloaded && (m_sampleCounter++ % m_sampleEvery) != 0) {
+            return 1;
+        }
+        if (m_queue.size() >= m_capacity) {
+            return 1;
+        }
+        m_queue.enqueue(message);
+        updateOverload();
+        return 0;
+    }
+    
+    int dropped = 0;
+    if (m_queue.size() >= m_capacity) {
+        m_queue.dequeue();
+        dropped = 1;
+    }
+    m_queue.enqueue(message);
+    updateOverload();
+    return dropped;
+}
+
+bool InboundBuffer::pop(Message *message)
+{
+    if (m_queue.isEmpty()) {
+        return false;
+    }
+    
+    *message = m_queue.dequeue();
+    updateOverload();
+    return true;
+}
+
+const InboundBuffer::Message &InboundBuffer::head() const
+{
+    return m_queue.head();
+}
+
+void InboundBuffer::clear()
+{
+    m_queue.clear();
+    updateOverload();
+}
+
+int InboundBuffer::size() const
+{
+    return m_queue.size();
+}
+
+bool InboundBuffer::isEmpty() const
+{
+    return m_queue.isEmpty();
+}
+
+bool InboundBuffer::isOverloaded() const
+{
+    return m_overloaded;
+}
+
+void InboundBuffer::updateOverload()
+{
+    // 高低水位之间保持原状态，避免在阈值附近反复切换
+    if (!m_overloaded && m_queue.size() >= m_highWatermark) {
+        m_overloaded = true;
+        m_sampleCounter = 0;
+    } else if (m_overloaded && m_queue.size() <= m_lowWatermark) {
+        m_overloaded = false;
+    }
+}
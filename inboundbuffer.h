@@ -0,0 +1,61 @@
+#ifndef INBOUNDBUFFER_H
+#define INBOUNDBUFFER_H
+
+#include <QQueue>
+#include <QVector>
+#include <QString>
+#include <QByteArray>
+
+// 入站消息缓冲：订阅回调只把消息放入有界队列，由 MqttClient 按速率分批取出处理
+// 队列长度达到高水位进入过载状态，回落到低水位才恢复；过载和队列满时按策略丢弃消息
+class InboundBuffer
+{
+public:
+    enum Policy {
+        DropOldest = 0,  // 队列满时丢弃最早的消息，保留最新的
+        Sample           // 过载期间每 N 条只保留 1 条，队列满时丢弃新消息
+    };
+    
+    struct Message
+    {
+        QVector<int> routeIds;
+        QString topic;
+        QByteArray payload;
+        bool duplicateFlag;
+        bool stateOnly;      // 同步阶段或保留消息，只更新门状态，不受速率限制
+        qint64 receivedAtUs;
+        qint64 receivedAtMs;
+    };
+    
+    explicit InboundBuffer(int capacity = 5000, int highWatermark = 4000, int lowWatermark = 1000);
+    
+    // 水位会被限制在 1 <= low < high <= capacity
+    void setLimits(int capacity, int highWatermark, int lowWatermark);
+    void setPolicy(Policy policy, int sampleEvery);
+    static Policy policyFromString(const QString &name);
+    
+    // 返回因这条消息而丢弃的消息数（0 或 1），可能是这条消息本身
+    int push(const Message &message);
+    bool pop(Message *message);
+    // 队首消息，队列为空时不能调用
+    const Message &head() const;
+    void clear();
+    
+    int size() const;
+    bool isEmpty() const;
+    bool isOverloaded() const;
+
+private:
+    void updateOverload();
+    
+    QQueue<Message> m_queue;
+    int m_capacity;
+    int m_highWatermark;
+    int m_lowWatermark;
+    Policy m_policy;
+    int m_sampleEvery;
+    int m_sampleCounter;
+    bool m_overloaded;
+};
+
+#endif // INBOUNDBUFFER_H
@@ -0,0 +1,129 @@
+#include "latencyhistogram.h"
+#include <chrono>
+#include <limits>
+
+namespace {
+const qint64 MaxTrackable = (qint64(1) << 36) - 1;
+const qint64 NoSample = std::numeric_limits<qint64>::max();
+}
+
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+qint64 LatencyHistogram::monotonicUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int LatencyHistogram::bucketIndex(qint64 valueUs)
+{
+    // 小于 64 的值每个值一个桶；更大的值按最高位确定移位，保留最高 6 位
+    if (valueUs < 2 * SubBucketHalf) {
+        return int(valueUs);
+    }
+    int msb = 63;
+    while (!(quint64(valueUs) & (quint64(1) << msb))) {
+        --msb;
+    }
+    int shift = msb - SubBucketBits;
+    return SubBucketHalf * shift + int(valueUs >> shift);
+}
+
+qint64 LatencyHistogram::bucketUpperBound(int index)
+{
+    if (index < 2 * SubBucketHalf) {
+        return index;
+    }
+    int shift = index / SubBucketHalf - 1;
+    qint64 lower = qint64(index - SubBucketHalf * shift) << shift;
+    return lower + (qint64(1) << shift) - 1;
+}
+
+void LatencyHistogram::record(qint64 valueUs)
+{
+    valueUs = qBound<qint64>(0, valueUs, MaxTrackable);
+    m_buckets[bucketIndex(valueUs)].fetchAndAddRelaxed(1);
+    m_count.fetchAndAddRelaxed(1);
+    m_sum.fetchAndAddRelaxed(quint64(valueUs));
+    
+    qint64 current = m_max.loadAcquire();
+    while (valueUs > current && !m_max.testAndSetOrdered(current, valueUs, current)) {
+    }
+    current = m_min.loadAcquire();
+    while (valueUs < current && !m_min.testAndSetOrdered(current, valueUs, current)) {
+    }
+}
+
+void LatencyHistogram::reset()
+{
+    for (int i = 0; i < BucketCount; ++i) {
+        m_buckets[i].store(0);
+    }
+    m_count.store(0);
+    m_sum.store(0);
+    m_max.store(0);
+    m_min.store(NoSample);
+}
+
+quint64 LatencyHistogram::count() const
+{
+    return m_count.loadAcquire();
+}
+
+qint64 LatencyHistogram::maxValue() const
+{
+    return m_max.loadAcquire();
+}
+
+qint64 LatencyHistogram::minValue() const
+{
+    qint64 value = m_min.loadAcquire();
+    return value == NoSample ? 0 : value;
+}
+
+quint64 LatencyHistogram::sum() const
+{
+    return m_sum.loadAcquire();
+}
+
+double LatencyHistogram::mean() const
+{
+    quint64 samples = count();
+    return samples == 0 ? 0.0 : double(m_sum.loadAcquire()) / samples;
+}
+
+qint64 LatencyHistogram::percentile(double percent) const
+{
+    quint64 total = count();
+    if (total == 0) {
+        return 0;
+    }
+    
+    quint64 target = quint64(qBound(0.0, percent, 100.0) / 100.0 * total + 0.5);
+    target = qBound<quint64>(1, target, total);
+    quint64 seen = 0;
+    for (int i = 0; i < BucketCount; ++i) {
+        seen += m_buckets[i].load();
+        if (seen >= target) {
+            // 桶上界可能超过实际最大值，取两者较小者
+            return qMin(bucketUpperBound(i), maxValue());
+        }
+    }
+    return maxValue();
+}
+
+QString LatencyHistogram::summary() const
+{
+    quint64 samples = count();
+    if (samples == 0) {
+        return "无数据";
+    }
+    return QString("p50 %1 ms, p99 %2 ms, max %3 ms (n=%4)")
+            .arg(percentile(50) / 1000.0, 0, 'f', 1)
+            .arg(percentile(99) / 1000.0, 0, 'f', 1)
+            .arg(maxValue() / 1000.0, 0, 'f', 1)
+            .arg(samples);
+}
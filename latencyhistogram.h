@@ -0,0 +1,46 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <QAtomicInteger>
+#include <QString>
+
+// 延迟直方图（微秒），按 HDR 方式分桶：每个 2 的幂区间再细分 32 个子桶，相对误差不超过 1/32
+// record() 只做原子加法，可在任意线程无锁调用；统计查询遍历全部桶，只在展示时使用
+class LatencyHistogram
+{
+public:
+    LatencyHistogram();
+    
+    void record(qint64 valueUs);   // 负值按 0 计，超出上限的按上限计
+    void reset();
+    
+    quint64 count() const;
+    qint64 maxValue() const;
+    qint64 minValue() const;       // 没有样本时返回 0
+    quint64 sum() const;
+    double mean() const;
+    qint64 percentile(double percent) const;  // percent 取 0 - 100，返回所在桶的上界
+    
+    // 形如 "p50 1.2 ms, p99 8.5 ms, max 12.0 ms (n=42)" 的摘要
+    QString summary() const;
+    
+    // 单调时钟（微秒），用于进程内各阶段计时
+    static qint64 monotonicUs();
+
+private:
+    static const int SubBucketBits = 5;
+    static const int SubBucketHalf = 1 << SubBucketBits;  // 32
+    static const int MaxShift = 30;                       // 上限 2^36 微秒（约 19 小时）
+    static const int BucketCount = SubBucketHalf * (MaxShift + 2);
+    
+    static int bucketIndex(qint64 valueUs);
+    static qint64 bucketUpperBound(int index);
+    
+    QAtomicInteger<quint32> m_buckets[BucketCount];
+    QAtomicInteger<quint64> m_count;
+    QAtomicInteger<quint64> m_sum;
+    QAtomicInteger<qint64> m_max;
+    QAtomicInteger<qint64> m_min;
+};
+
+#endif // LATENCYHISTOGRAM_H
@@ -0,0 +1,106 @@
+#include "latencymonitor.h"
+#include <QDateTime>
+#include <limits>
+
+namespace {
+const qint64 SkewWindowUs = qint64(10) * 60 * 1000 * 1000;  // 10 分钟
+const qint64 NoSample = std::numeric_limits<qint64>::max();
+}
+
+LatencyMonitor::LatencyMonitor()
+    : m_windowStartUs(0)
+    , m_windowMinMs(NoSample)
+    , m_previousWindowMinMs(NoSample)
+    , m_skewMs(0)
+    , m_hasSkew(0)
+{
+}
+
+void LatencyMonitor::recordEvent(const DoorEvent &event)
+{
+    if (event.receivedAtUs <= 0) {
+        return;
+    }
+    
+    qint64 shownAtUs = LatencyHistogram::monotonicUs();
+    qint64 shownAtMs = QDateTime::currentMSecsSinceEpoch();
+    
+    if (event.parsedAtUs > 0) {
+        m_parse.record(event.parsedAtUs - event.receivedAtUs);
+        m_dispatch.record(shownAtUs - event.parsedAtUs);
+    }
+    
+    if (!event.dateTime.isValid()) {
+        return;
+    }
+    
+    qint64 brokerMs = event.dateTime.toMSecsSinceEpoch();
+    qint64 transitMs = event.receivedAtMs - brokerMs;
+    updateSkew(transitMs);
+    
+    // 两台机器的时钟不同步时原始值可能为负，直方图按 0 记录
+    qint64 endToEndMs = shownAtMs - brokerMs;
+    m_transit.record(transitMs * 1000);
+    m_endToEnd.record(endToEndMs * 1000);
+    m_endToEndCorrected.record((endToEndMs - m_skewMs.load()) * 1000);
+}
+
+void LatencyMonitor::recordSoundStart(qint64 latencyUs)
+{
+    m_sound.record(latencyUs);
+}
+
+void LatencyMonitor::updateSkew(qint64 transitMs)
+{
+    qint64 nowUs = LatencyHistogram::monotonicUs();
+    if (m_windowStartUs == 0 || nowUs - m_windowStartUs >= SkewWindowUs) {
+        m_previousWindowMinMs = m_windowMinMs;
+        m_windowMinMs = NoSample;
+        m_windowStartUs = nowUs;
+    }
+    m_windowMinMs = qMin(m_windowMinMs, transitMs);
+    
+    m_skewMs.store(qMin(m_windowMinMs, m_previousWindowMinMs));
+    m_hasSkew.store(1);
+}
+
+void LatencyMonitor::reset()
+{
+    m_transit.reset();
+    m_parse.reset();
+    m_dispatch.reset();
+    m_sound.reset();
+    m_endToEnd.reset();
+    m_endToEndCorrected.reset();
+    m_windowStartUs = 0;
+    m_windowMinMs = NoSample;
+    m_previousWindowMinMs = NoSample;
+    m_skewMs.store(0);
+    m_hasSkew.store(0);
+}
+
+qint64 LatencyMonitor::clockSkewMs() const
+{
+    return m_skewMs.load();
+}
+
+bool LatencyMonitor::hasClockSkew() const
+{
+    return m_hasSkew.load() != 0;
+}
+
+QString LatencyMonitor::report() const
+{
+    QString text;
+    text += QString("端到端: %1\n").arg(m_endToEnd.summary());
+    if (hasClockSkew()) {
+        text += QString("端到端（扣除时钟偏差 %1 ms）: %2\n")
+                .arg(clockSkewMs())
+                .arg(m_endToEndCorrected.summary());
+    }
+    text += QString("传输: %1\n").arg(m_transit.summary());
+    text += QString("解析: %1\n").arg(m_parse.summary());
+    text += QString("分发显示: %1\n").arg(m_dispatch.summary());
+    text += QString("提示音启动: %1\n").arg(m_sound.summary());
+    return text;
+}
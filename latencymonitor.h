@@ -0,0 +1,58 @@
+#ifndef LATENCYMONITOR_H
+#define LATENCYMONITOR_H
+
+#include <QString>
+#include <QAtomicInteger>
+#include "latencyhistogram.h"
+#include "doorevent.h"
+
+// 端到端延迟统计：从门禁控制器打时间戳到通知弹出，按阶段分别记录直方图
+//   transit   服务端时间戳 -> 收到消息（跨机器，受时钟偏差影响）
+//   parse     收到消息 -> 解析完成
+//   dispatch  解析完成 -> 通知显示
+//   sound     调用 play() -> 音频实际开始播放
+//   endToEnd  服务端时间戳 -> 通知显示，另记录一份扣除时钟偏差估计后的结果
+class LatencyMonitor
+{
+public:
+    LatencyMonitor();
+    
+    // 通知显示后调用；事件没有有效时间戳时只记录进程内阶段
+    void recordEvent(const DoorEvent &event);
+    void recordSoundStart(qint64 latencyUs);
+    void reset();
+    
+    const LatencyHistogram &transit() const { return m_transit; }
+    const LatencyHistogram &parse() const { return m_parse; }
+    const LatencyHistogram &dispatch() const { return m_dispatch; }
+    const LatencyHistogram &sound() const { return m_sound; }
+    const LatencyHistogram &endToEnd() const { return m_endToEnd; }
+    const LatencyHistogram &endToEndCorrected() const { return m_endToEndCorrected; }
+    
+    // 时钟偏差估计（毫秒）：近两个窗口内 (收到时间 - 服务端时间) 的最小值，
+    // 即本机时钟相对控制器的偏移加上最小网络延迟；没有样本时返回 0
+    qint64 clockSkewMs() const;
+    bool hasClockSkew() const;
+    
+    // 多行文本，供托盘状态窗口显示
+    QString report() const;
+
+private:
+    void updateSkew(qint64 transitMs);
+    
+    LatencyHistogram m_transit;
+    LatencyHistogram m_parse;
+    LatencyHistogram m_dispatch;
+    LatencyHistogram m_sound;
+    LatencyHistogram m_endToEnd;
+    LatencyHistogram m_endToEndCorrected;
+    
+    // 滑动最小值：当前窗口和上一个窗口各保留一个最小值，窗口切换时前移
+    qint64 m_windowStartUs;
+    qint64 m_windowMinMs;
+    qint64 m_previousWindowMinMs;
+    QAtomicInteger<qint64> m_skewMs;
+    QAtomicInt m_hasSkew;
+};
+
+#endif // LATENCYMONITOR_H
@@ -2,15 +2,100 @@
 #include <QCoreApplication>
 #include <QDebug>
 #include <QDir>
+#include <QThread>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QVector>
+#include <QJsonObject>
+#include <QJsonDocument>
+#include <csignal>
 
-Logger* Logger::m_instance = nullptr;
+// 后台日志写入线程，批量把队列中的日志写入磁盘
+class LogWriterThread : public QThread
+{
+public:
+    explicit LogWriterThread(Logger *logger)
+        : m_logger(logger)
+    {
+    }
+
+protected:
+    void run() override
+    {
+        m_logger->writerLoop();
+    }
+
+private:
+    Logger *m_logger;
+};
+
+// 后台日志维护任务：压缩切分出的文件，按保留天数和文件数删除旧日志
+class LogMaintenanceTask : public QRunnable
+{
+public:
+    explicit LogMaintenanceTask(Logger *logger)
+        : m_logger(logger)
+    {
+    }
+    
+    void run() override
+    {
+        m_logger->runMaintenance();
+    }
+
+private:
+    Logger *m_logger;
+};
+
+namespace {
+
+quint32 crc32(const QByteArray &data)
+{
+    static const QVector<quint32> table = []() {
+        QVector<quint32> entries(256);
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 value = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                value = (value & 1) ? (0xEDB88320u ^ (value >> 1)) : (value >> 1);
+            }
+            entries[int(i)] = value;
+        }
+        return entries;
+    }();
+    
+    quint32 crc = 0xFFFFFFFFu;
+    for (char c : data) {
+        crc = table[int((crc ^ quint8(c)) & 0xFF)] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+void appendLittleEndian32(QByteArray *data, quint32 value)
+{
+    for (int i = 0; i < 4; ++i) {
+        data->append(char((value >> (8 * i)) & 0xFF));
+    }
+}
+
+} // namespace
+
+QAtomicPointer<Logger> Logger::m_instance;
 
 Logger* Logger::instance()
 {
-    if (!m_instance) {
-        m_instance = new Logger();
+    // 双重检查：创建之后每次调用只有一次原子读取，不加锁
+    Logger *logger = m_instance.loadAcquire();
+    if (!logger) {
+        static QMutex instanceMutex;
+        QMutexLocker locker(&instanceMutex);
+        logger = m_instance.loadAcquire();
+        if (!logger) {
+            logger = new Logger();
+            m_instance.storeRelease(logger);
+        }
     }
-    return m_instance;
+    return logger;
 }
 
 Logger::Logger(QObject *parent)
@@ -19,7 +104,30 @@ Logger::Logger(QObject *parent)
     , logStream(nullptr)
     , logPath(QDir::homePath() + "/logs")
     , retentionDays(7)
+    , maxFileSize(0)
+    , maxFiles(0)
+    , compressRotated(false)
+    , logFormat(Text)
+    , maintenancePending(0)
+    , writerThread(nullptr)
+    , writerStopping(false)
+    , asyncEnabled(0)
+    , flushIntervalMs(1000)
+    , flushThreshold(64)
+    , queueCapacity(10000)
+    , pendingCount(0)
+    , dropped(0)
+    , reportedDropped(0)
+    , payloadMaxBytes(512)
+    , payloadSampleRate(1)
+    , oversizedPayloads(0)
 {
+    // 未配置前记录所有级别
+    for (int i = 0; i < CategoryCount; ++i) {
+        categoryLevels[i].store(Debug);
+    }
+    maintenancePool.setMaxThreadCount(1);
+    
     currentDate = QDate::currentDate().toString("yyyy-MM-dd");
     // 使用默认路径打开日志文件
     openLogFile();
@@ -27,6 +135,7 @@ Logger::Logger(QObject *parent)
 
 Logger::~Logger()
 {
+    shutdown();
     closeLogFile();
 }
 
@@ -34,39 +143,338 @@ void Logger::setLogPath(const QString &path)
 {
     QMutexLocker locker(&mutex);
     if (logPath != path) {
+        // 切换路径前先把旧文件对应的日志写完
+        drainQueue();
         closeLogFile();
         logPath = path;
         // 只有在路径非空时才打开日志文件
         if (!logPath.isEmpty()) {
             openLogFile();
+            scheduleMaintenance();
         }
     }
 }
 
 void Logger::setRetentionDays(int days)
 {
+    QMutexLocker locker(&mutex);
     retentionDays = days;
+    scheduleMaintenance();
+}
+
+void Logger::setMaxFileSize(qint64 maxBytes)
+{
+    QMutexLocker locker(&mutex);
+    maxFileSize = qMax<qint64>(0, maxBytes);
+}
+
+void Logger::setMaxFiles(int count)
+{
+    QMutexLocker locker(&mutex);
+    maxFiles = qMax(0, count);
+    scheduleMaintenance();
+}
+
+void Logger::setCompressRotated(bool enabled)
+{
+    QMutexLocker locker(&mutex);
+    compressRotated = enabled;
+    scheduleMaintenance();
 }
 
 void Logger::log(const QString &message, const QString &level)
+{
+    LogRecord record;
+    record.time = QDateTime::currentDateTime();
+    record.level = level;
+    record.message = message;
+    submit(record);
+}
+    
+void Logger::log(Level level, Category category, const QString &message)
+{
+    LogRecord record;
+    record.time = QDateTime::currentDateTime();
+    record.level = levelName(level);
+    record.category = categoryName(category);
+    record.message = message;
+    submit(record);
+}
+
+void Logger::logEvent(Level level, Category category, const QString &message,
+                      const QString &doorId, const QString &eventType)
+{
+    LogRecord record;
+    record.time = QDateTime::currentDateTime();
+    record.level = levelName(level);
+    record.category = categoryName(category);
+    record.message = message;
+    record.doorId = doorId;
+    record.eventType = eventType;
+    submit(record);
+}
+
+void Logger::submit(const LogRecord &record)
+{
+    if (asyncEnabled.load()) {
+        // 异步模式：只入队，不在调用线程做任何磁盘 I/O
+        QMutexLocker queueLocker(&queueMutex);
+        // 关闭异步模式时标志在 queueMutex 下修改，这里再检查一次，
+        // 保证不会在 stopWriter() 最后一次写出之后才入队
+        if (asyncEnabled.load()) {
+            if (queue.size() >= queueCapacity) {
+                dropped.fetchAndAddRelaxed(1);
+                return;
+            }
+            queue.enqueue(record);
+            pendingCount.store(queue.size());
+            if (queue.size() >= flushThreshold) {
+                queueNotEmpty.wakeOne();
+            }
+            return;
+        }
+    }
+    
+    QMutexLocker locker(&mutex);
+    writeRecord(record);
+    if (logStream) {
+        logStream->flush();
+    }
+    rotateIfTooLarge();
+}
+
+void Logger::setLevel(Level level)
+{
+    for (int i = 0; i < CategoryCount; ++i) {
+        categoryLevels[i].store(level);
+    }
+}
+
+void Logger::setCategoryLevel(Category category, Level level)
+{
+    if (category >= 0 && category < CategoryCount) {
+        categoryLevels[category].store(level);
+    }
+}
+
+Logger::Level Logger::levelFromString(const QString &name, Level defaultLevel)
+{
+    QString lower = name.trimmed().toLower();
+    if (lower == "debug") {
+        return Debug;
+    } else if (lower == "info") {
+        return Info;
+    } else if (lower == "warning" || lower == "warn") {
+        return Warning;
+    } else if (lower == "error") {
+        return Error;
+    }
+    return defaultLevel;
+}
+
+QString Logger::levelName(Level level)
+{
+    switch (level) {
+    case Debug:
+        return QStringLiteral("DEBUG");
+    case Info:
+        return QStringLiteral("INFO");
+    case Warning:
+        return QStringLiteral("WARNING");
+    case Error:
+        return QStringLiteral("ERROR");
+    }
+    return QStringLiteral("INFO");
+}
+
+void Logger::setFormat(Format format)
+{
+    QMutexLocker locker(&mutex);
+    if (logFormat != format) {
+        // 已在队列中的日志按旧格式写出，同一行不会混用两种格式
+        drainQueue();
+        logFormat = format;
+    }
+}
+
+Logger::Format Logger::formatFromString(const QString &name)
+{
+    QString lower = name.trimmed().toLower();
+    if (lower == "jsonl" || lower == "json") {
+        return Jsonl;
+    }
+    return Text;
+}
+
+QString Logger::categoryName(Category category)
+{
+    switch (category) {
+    case General:
+        return QStringLiteral("general");
+    case Mqtt:
+        return QStringLiteral("mqtt");
+    case Ui:
+        return QStringLiteral("ui");
+    case Config:
+        return QStringLiteral("config");
+    case CategoryCount:
+        break;
+    }
+    return QStringLiteral("general");
+}
+
+void Logger::setPayloadMaxBytes(int maxBytes)
+{
+    payloadMaxBytes.store(maxBytes);
+}
+
+void Logger::setPayloadSampleRate(int everyN)
+{
+    payloadSampleRate.store(qMax(1, everyN));
+}
+
+QString Logger::payloadPreview(const QByteArray &payload)
+{
+    int limit = payloadMaxBytes.load();
+    if (limit <= 0 || payload.size() <= limit) {
+        return QString::fromUtf8(payload);
+    }
+    
+    // 超长负载按采样率记录，其余只记录长度
+    int rate = payloadSampleRate.load();
+    int sequence = oversizedPayloads.fetchAndAddRelaxed(1);
+    if (rate > 1 && static_cast<uint>(sequence) % static_cast<uint>(rate) != 0) {
+        return QString("<%1 字节，已按采样省略>").arg(payload.size());
+    }
+    
+    // 避免在 UTF-8 多字节字符中间截断
+    while (limit > 0 && (static_cast<uchar>(payload.at(limit)) & 0xC0) == 0x80) {
+        --limit;
+    }
+    return QString("%1...(共 %2 字节)").arg(QString::fromUtf8(payload.constData(), limit)).arg(payload.size());
+}
+
+void Logger::setAsyncEnabled(bool enabled)
+{
+    if (enabled == isAsyncEnabled()) {
+        return;
+    }
+    
+    if (enabled) {
+        {
+            QMutexLocker queueLocker(&queueMutex);
+            writerStopping = false;
+        }
+        writerThread = new LogWriterThread(this);
+        asyncEnabled.store(1);
+        writerThread->start(QThread::LowPriority);
+    } else {
+        {
+            QMutexLocker queueLocker(&queueMutex);
+            asyncEnabled.store(0);
+        }
+        // 此后的日志同步写入，队列中剩余的由 stopWriter() 写出
+        stopWriter();
+    }
+}
+
+bool Logger::isAsyncEnabled() const
+{
+    return asyncEnabled.load() != 0;
+}
+
+void Logger::setFlushInterval(int intervalMs)
+{
+    QMutexLocker queueLocker(&queueMutex);
+    flushIntervalMs = qMax(10, intervalMs);
+}
+
+void Logger::setFlushThreshold(int records)
+{
+    QMutexLocker queueLocker(&queueMutex);
+    flushThreshold = qMax(1, records);
+}
+
+void Logger::setQueueCapacity(int capacity)
+{
+    QMutexLocker queueLocker(&queueMutex);
+    queueCapacity = qMax(1, capacity);
+}
+
+void Logger::flush()
 {
     QMutexLocker locker(&mutex);
+    drainQueue();
+}
+
+void Logger::shutdown()
+{
+    setAsyncEnabled(false);
+    flush();
+    // 等待正在进行的压缩完成，未开始的任务留到下次启动
+    maintenancePool.clear();
+    maintenancePool.waitForDone();
+}
+
+void Logger::installCrashHandler()
+{
+    std::signal(SIGSEGV, &Logger::crashSignalHandler);
+    std::signal(SIGABRT, &Logger::crashSignalHandler);
+    std::signal(SIGFPE, &Logger::crashSignalHandler);
+    std::signal(SIGILL, &Logger::crashSignalHandler);
+}
+
+int Logger::queueDepth() const
+{
+    return pendingCount.load();
+}
+
+quint64 Logger::droppedCount() const
+{
+    return dropped.load();
+}
+
+QString Logger::formatRecord(const LogRecord &record) const
+{
+    if (logFormat == Jsonl) {
+        QJsonObject object;
+        object.insert("time", record.time.toString("yyyy-MM-ddTHH:mm:ss.zzz"));
+        object.insert("ts", record.time.toMSecsSinceEpoch());
+        object.insert("level", record.level);
+        if (!record.category.isEmpty()) {
+            object.insert("category", record.category);
+        }
+        if (!record.doorId.isEmpty()) {
+            object.insert("door", record.doorId);
+        }
+        if (!record.eventType.isEmpty()) {
+            object.insert("event", record.eventType);
+        }
+        object.insert("msg", record.message);
+        return QString::fromUtf8(QJsonDocument(object).toJson(QJsonDocument::Compact));
+    }
+    
+    QString timestamp = record.time.toString("yyyy-MM-dd HH:mm:ss");
+    return QString("[%1] [%2] %3").arg(timestamp).arg(record.level).arg(record.message);
+}
+
+void Logger::writeRecord(const LogRecord &record)
+{
+    QString logMessage = formatRecord(record);
     
     // 如果日志文件未初始化（路径为空），则只输出到控制台
     if (logPath.isEmpty()) {
-        QString timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss");
-        QString logMessage = QString("[%1] [%2] %3").arg(timestamp).arg(level).arg(message);
         qDebug().noquote() << logMessage;
         return;
     }
     
     // 检查日期是否变化，如果变化则切换日志文件
-    QString today = QDate::currentDate().toString("yyyy-MM-dd");
-    if (today != currentDate) {
-        currentDate = today;
+    QString recordDate = record.time.date().toString("yyyy-MM-dd");
+    if (recordDate > currentDate) {
+        currentDate = recordDate;
         closeLogFile();
         openLogFile();
-        cleanOldLogs();
+        scheduleMaintenance();
     }
     
     if (!logStream) {
@@ -74,17 +482,120 @@ void Logger::log(const QString &message, const QString &level)
         return;
     }
     
-    QString timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss");
-    QString logMessage = QString("[%1] [%2] %3").arg(timestamp).arg(level).arg(message);
-    
     // 写入文件
     *logStream << logMessage << "\n";
-    logStream->flush();
     
     // 同时输出到控制台
     qDebug().noquote() << logMessage;
 }
 
+void Logger::writeBatch(const QQueue<LogRecord> &batch)
+{
+    for (const LogRecord &record : batch) {
+        writeRecord(record);
+    }
+    
+    // 队列满时丢弃的日志数量写入日志，便于排查
+    quint64 droppedNow = dropped.load();
+    if (droppedNow > reportedDropped) {
+        LogRecord notice;
+        notice.time = QDateTime::currentDateTime();
+        notice.level = "WARNING";
+        notice.message = QString("日志队列已满，丢弃了 %1 条日志").arg(droppedNow - reportedDropped);
+        writeRecord(notice);
+        reportedDropped = droppedNow;
+    }
+    
+    if (logStream) {
+        logStream->flush();
+    }
+    rotateIfTooLarge();
+}
+
+void Logger::drainQueue()
+{
+    // 调用方需持有 mutex，保证多个批次按入队顺序写入
+    QQueue<LogRecord> batch;
+    {
+        QMutexLocker queueLocker(&queueMutex);
+        batch.swap(queue);
+        pendingCount.store(0);
+    }
+    
+    if (!batch.isEmpty() || dropped.load() > reportedDropped) {
+        writeBatch(batch);
+    }
+}
+
+void Logger::writerLoop()
+{
+    forever {
+        {
+            QMutexLocker queueLocker(&queueMutex);
+            if (!writerStopping && queue.size() < flushThreshold) {
+                queueNotEmpty.wait(&queueMutex, flushIntervalMs);
+            }
+            if (writerStopping && queue.isEmpty()) {
+                break;
+            }
+        }
+        
+        QMutexLocker locker(&mutex);
+        drainQueue();
+    }
+}
+
+void Logger::stopWriter()
+{
+    if (!writerThread) {
+        return;
+    }
+    
+    {
+        QMutexLocker queueLocker(&queueMutex);
+        writerStopping = true;
+        queueNotEmpty.wakeAll();
+    }
+    
+    writerThread->wait();
+    delete writerThread;
+    writerThread = nullptr;
+    
+    // 写出停止期间仍然进入队列的日志
+    flush();
+}
+
+void Logger::emergencyFlush()
+{
+    // 注意：这里不是异步信号安全的——会加锁、分配内存并格式化时间，崩溃现场的堆或锁
+    // 已损坏时可能写不出来甚至卡住（最多等待两次 200 ms）；只作为尽力而为的补救
+    if (!mutex.tryLock(200)) {
+        return;
+    }
+    
+    QQueue<LogRecord> batch;
+    if (queueMutex.tryLock(200)) {
+        batch.swap(queue);
+        pendingCount.store(0);
+        queueMutex.unlock();
+    }
+    writeBatch(batch);
+    
+    mutex.unlock();
+}
+
+void Logger::crashSignalHandler(int signalNumber)
+{
+    Logger *logger = m_instance.loadAcquire();
+    if (logger) {
+        logger->emergencyFlush();
+    }
+    
+    // 恢复默认处理并重新触发信号，保留原有的崩溃行为
+    std::signal(signalNumber, SIG_DFL);
+    std::raise(signalNumber);
+}
+
 void Logger::openLogFile()
 {
     // 创建日志目录
@@ -127,30 +638,152 @@ void Logger::closeLogFile()
     }
 }
 
-void Logger::cleanOldLogs()
+void Logger::rotateIfTooLarge()
 {
-    if (retentionDays <= 0) {
+    // 调用方需持有 mutex
+    if (maxFileSize <= 0 || !logFile || logFile->size() < maxFileSize) {
         return;
     }
     
-    QDir dir(logPath);
-    QFileInfoList fileList = dir.entryInfoList(QStringList() << "DoorState_*.log", 
-                                                QDir::Files, 
-                                                QDir::Time | QDir::Reversed);
+    // 当前文件改名后重新打开同名文件，logindex 和外部工具始终读取 DoorState_日期.log
+    QString activePath = getCurrentLogFileName();
+    QString rotatedPath = QDir(logPath).filePath(QString("DoorState_%1.%2.log")
+            .arg(currentDate)
+            .arg(QTime::currentTime().toString("HHmmsszzz")));
+    closeLogFile();
+    if (!QFile::rename(activePath, rotatedPath)) {
+        qWarning() << "Failed to rotate log file:" << activePath;
+    }
+    openLogFile();
+    scheduleMaintenance();
+}
+
+void Logger::scheduleMaintenance()
+{
+    if (maintenancePending.testAndSetOrdered(0, 1)) {
+        maintenancePool.start(new LogMaintenanceTask(this));
+    }
+}
+
+void Logger::runMaintenance()
+{
+    // 先清除标记，之后发生的切分会再排一个任务
+    maintenancePending.store(0);
     
-    QDate cutoffDate = QDate::currentDate().addDays(-retentionDays);
+    QString path;
+    QString activeDate;
+    int days;
+    int limit;
+    bool compress;
+    {
+        QMutexLocker locker(&mutex);
+        path = logPath;
+        activeDate = currentDate;
+        days = retentionDays;
+        limit = maxFiles;
+        compress = compressRotated;
+    }
+    if (path.isEmpty()) {
+        return;
+    }
     
-    for (const QFileInfo &fileInfo : fileList) {
-        QString baseName = fileInfo.baseName();
-        // 提取日期部分: DoorState_2025-12-16.log -> 2025-12-16
-        QString dateStr = baseName.mid(10); // "DoorState_" 长度为 10
-        QDate fileDate = QDate::fromString(dateStr, "yyyy-MM-dd");
+    // 目录在释放锁之后才列出，期间可能跨日打开了新的日志文件，所以不能只排除快照时的当前文件名：
+    // 快照日期当天及之后的未切分文件都跳过，前一天的文件留到下次维护再压缩
+    QDir dir(path);
+    if (compress) {
+        for (const QString &name : dir.entryList(QStringList() << "DoorState_*.log", QDir::Files, QDir::Name)) {
+            if (!isActiveLogName(name, activeDate) && !compressFile(dir.filePath(name))) {
+                qWarning() << "Failed to compress log file:" << name;
+            }
+        }
+    }
+    cleanOldLogs(dir, activeDate, days, limit);
+}
+
+bool Logger::compressFile(const QString &path)
+{
+    QFile source(path);
+    if (!source.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QByteArray data = source.readAll();
+    source.close();
+    
+    if (!data.isEmpty()) {
+        // qCompress 输出为 4 字节长度 + 2 字节 zlib 头 + deflate 数据 + 4 字节 adler32，
+        // 去掉头尾后加上 gzip 头和 crc32/长度尾，得到标准 .gz 文件
+        QByteArray deflated = qCompress(data, 6);
+        if (deflated.size() < 10) {
+            return false;
+        }
+        static const char gzipHeader[10] = { '\x1f', '\x8b', 8, 0, 0, 0, 0, 0, 0, '\xff' };
+        QByteArray gzip;
+        gzip.reserve(deflated.size() + 12);
+        gzip.append(gzipHeader, sizeof(gzipHeader));
+        gzip.append(deflated.constData() + 6, deflated.size() - 10);
+        appendLittleEndian32(&gzip, crc32(data));
+        appendLittleEndian32(&gzip, quint32(data.size()));
         
-        if (fileDate.isValid() && fileDate < cutoffDate) {
-            if (dir.remove(fileInfo.fileName())) {
-                qDebug() << "Removed old log file:" << fileInfo.fileName();
+        QSaveFile target(path + ".gz");
+        if (!target.open(QIODevice::WriteOnly) || target.write(gzip) != gzip.size() || !target.commit()) {
+            return false;
+        }
+    }
+    
+    if (!QFile::remove(path)) {
+        // 原文件删不掉时撤销压缩结果，避免同一份日志同时存在 .log 和 .gz，下次维护再试
+        QFile::remove(path + ".gz");
+        return false;
+    }
+    // logindex 的索引对应未压缩的文件，一并删除
+    QFile::remove(path + ".idx");
+    return true;
+}
+
+bool Logger::isActiveLogName(const QString &name, const QString &activeDate)
+{
+    // DoorState_2025-12-16.log；切分出的文件带时间后缀，已经关闭
+    static const int ActiveNameLength = 24;
+    if (name.size() != ActiveNameLength || !name.endsWith(".log")) {
+        return false;
+    }
+    // yyyy-MM-dd 按字符串比较即按日期比较
+    return name.mid(10, 10) >= activeDate;
+}
+
+void Logger::cleanOldLogs(const QDir &dir, const QString &activeDate, int retentionDays, int maxFiles)
+{
+    // 文件名按日期和切分时间排序，同一天按大小切分出的文件排在日终文件之前
+    QStringList names;
+    for (const QString &name : dir.entryList(QStringList() << "DoorState_*.log" << "DoorState_*.log.gz",
+                                             QDir::Files, QDir::Name)) {
+        if (!isActiveLogName(name, activeDate)) {
+            names.append(name);
+        }
+    }
+    
+    QDate cutoffDate = QDate::currentDate().addDays(-retentionDays);
+    QStringList kept;
+    for (const QString &name : names) {
+        // 提取日期部分: DoorState_2025-12-16.083015123.log.gz -> 2025-12-16
+        QDate fileDate = QDate::fromString(name.mid(10, 10), "yyyy-MM-dd");
+        if (retentionDays > 0 && fileDate.isValid() && fileDate < cutoffDate) {
+            if (dir.remove(name)) {
+                qDebug() << "Removed old log file:" << name;
             }
+            dir.remove(name + ".idx");
+        } else {
+            kept.append(name);
+        }
+    }
+    
+    // 超出文件数上限时从最早的开始删除
+    while (maxFiles > 0 && kept.size() > maxFiles) {
+        QString name = kept.takeFirst();
+        if (dir.remove(name)) {
+            qDebug() << "Removed log file over limit:" << name;
         }
+        dir.remove(name + ".idx");
     }
 }
 
@@ -7,40 +7,210 @@
 #include <QDir>
 #include <QDateTime>
 #include <QMutex>
+#include <QWaitCondition>
+#include <QQueue>
+#include <QAtomicInteger>
+#include <QAtomicPointer>
+#include <QThreadPool>
+
+class LogWriterThread;
+class LogMaintenanceTask;
 
 class Logger : public QObject
 {
     Q_OBJECT
 
 public:
+    // 日志级别，数值越大越重要
+    enum Level {
+        Debug = 0,
+        Info,
+        Warning,
+        Error
+    };
+    
+    // 日志分类，每个分类可以单独设置级别
+    enum Category {
+        General = 0,
+        Mqtt,
+        Ui,
+        Config,
+        CategoryCount
+    };
+    
+    // 日志文件格式：Text 为 "[时间] [级别] 消息" 文本行，Jsonl 为每行一个 JSON 对象，
+    // 包含 time/ts/level/category/door/event/msg 字段，可用 tools/logindex 建立索引后检索
+    enum Format {
+        Text = 0,
+        Jsonl
+    };
+    
+    // 线程安全，任意线程都可以写日志
     static Logger* instance();
     
     void setLogPath(const QString &path);
     void setRetentionDays(int days);
+    // 按大小切分：当前文件超过 maxBytes 后改名为 DoorState_日期.时间.log 并打开新文件，0 表示只按日期切分
+    void setMaxFileSize(qint64 maxBytes);
+    // 最多保留的历史日志文件数（不含当前文件），0 表示不限制
+    void setMaxFiles(int count);
+    // 切分出的历史文件在后台压缩为 .gz
+    void setCompressRotated(bool enabled);
     void log(const QString &message, const QString &level = "INFO");
+    void log(Level level, Category category, const QString &message);
+    // 带门编号和事件类型的日志，Jsonl 格式下写成独立字段
+    void logEvent(Level level, Category category, const QString &message,
+                  const QString &doorId, const QString &eventType);
+    
+    void setFormat(Format format);
+    static Format formatFromString(const QString &name);
+    static QString categoryName(Category category);
+    
+    // 级别过滤：宏在格式化消息之前调用 isEnabled()，被过滤的日志不产生任何字符串开销
+    void setLevel(Level level);
+    void setCategoryLevel(Category category, Level level);
+    bool isEnabled(Level level, Category category = General) const
+    {
+        return level >= categoryLevels[category].load();
+    }
+    static Level levelFromString(const QString &name, Level defaultLevel = Info);
+    static QString levelName(Level level);
     
+    // 负载日志：超过上限的负载截断，并按采样率只记录其中一部分
+    void setPayloadMaxBytes(int maxBytes);
+    void setPayloadSampleRate(int everyN);
+    QString payloadPreview(const QByteArray &payload);
+    
+    // 异步模式：日志先进入有界队列，由后台线程批量写入磁盘
+    void setAsyncEnabled(bool enabled);
+    bool isAsyncEnabled() const;
+    void setFlushInterval(int intervalMs);
+    void setFlushThreshold(int records);
+    void setQueueCapacity(int capacity);
+    
+    // 立即把队列中的日志写入磁盘
+    void flush();
+    // 程序退出前调用：停止后台线程并写完剩余日志
+    void shutdown();
+    // 安装崩溃信号处理，崩溃时尽力写出队列中的日志
+    // 处理函数会加锁和分配内存，不是异步信号安全的，不能保证一定写出
+    void installCrashHandler();
+    
+    int queueDepth() const;
+    quint64 droppedCount() const;
+
 private:
+    friend class LogWriterThread;
+    friend class LogMaintenanceTask;
+    
+    struct LogRecord
+    {
+        QDateTime time;
+        QString level;
+        QString category;
+        QString message;
+        QString doorId;
+        QString eventType;
+    };
+    
     explicit Logger(QObject *parent = nullptr);
     ~Logger();
     
     void openLogFile();
     void closeLogFile();
-    void cleanOldLogs();
+    void rotateIfTooLarge();
+    
+    // 压缩和清理在后台线程执行，写日志的线程不做目录扫描和删除
+    void scheduleMaintenance();
+    void runMaintenance();
+    static bool compressFile(const QString &path);
+    // 当天或之后日期的未切分文件 DoorState_<日期>.log 可能正在写入，压缩和清理都跳过
+    static bool isActiveLogName(const QString &name, const QString &activeDate);
+    static void cleanOldLogs(const QDir &dir, const QString &activeDate, int retentionDays, int maxFiles);
     QString getCurrentLogFileName() const;
     
-    static Logger *m_instance;
+    void submit(const LogRecord &record);
+    QString formatRecord(const LogRecord &record) const;
+    void writeRecord(const LogRecord &record);
+    void writeBatch(const QQueue<LogRecord> &batch);
+    void drainQueue();
+    void writerLoop();
+    void stopWriter();
+    void emergencyFlush();
+    static void crashSignalHandler(int signalNumber);
+    
+    static QAtomicPointer<Logger> m_instance;
     QFile *logFile;
     QTextStream *logStream;
     QString logPath;
     int retentionDays;
+    qint64 maxFileSize;
+    int maxFiles;
+    bool compressRotated;
     QMutex mutex;
     QString currentDate;
+    Format logFormat;
+    
+    // 后台维护相关，单线程执行，同一时间最多排队一个任务
+    QThreadPool maintenancePool;
+    QAtomicInt maintenancePending;
+    
+    // 异步写入相关
+    QMutex queueMutex;
+    QWaitCondition queueNotEmpty;
+    QQueue<LogRecord> queue;
+    LogWriterThread *writerThread;
+    bool writerStopping;
+    QAtomicInt asyncEnabled;
+    int flushIntervalMs;
+    int flushThreshold;
+    int queueCapacity;
+    QAtomicInt pendingCount;
+    QAtomicInteger<quint64> dropped;
+    quint64 reportedDropped;
+    
+    // 级别过滤相关
+    QAtomicInt categoryLevels[CategoryCount];
+    QAtomicInt payloadMaxBytes;
+    QAtomicInt payloadSampleRate;
+    QAtomicInt oversizedPayloads;
 };
 
+// 先检查级别再求值 msg，被过滤的日志不会构造 QString
+#define LOG_AT(level, category, msg) \
+    do { \
+        Logger *logger_ = Logger::instance(); \
+        if (logger_->isEnabled(level, category)) { \
+            logger_->log(level, category, msg); \
+        } \
+    } while (0)
+
 // 便捷宏
-#define LOG_INFO(msg) Logger::instance()->log(msg, "INFO")
-#define LOG_ERROR(msg) Logger::instance()->log(msg, "ERROR")
-#define LOG_WARNING(msg) Logger::instance()->log(msg, "WARNING")
-#define LOG_DEBUG(msg) Logger::instance()->log(msg, "DEBUG")
+#define LOG_INFO(msg) LOG_AT(Logger::Info, Logger::General, msg)
+#define LOG_ERROR(msg) LOG_AT(Logger::Error, Logger::General, msg)
+#define LOG_WARNING(msg) LOG_AT(Logger::Warning, Logger::General, msg)
+
+// 带分类的便捷宏，category 取 Logger::Mqtt / Logger::Ui / Logger::Config
+#define LOG_INFO_CAT(category, msg) LOG_AT(Logger::Info, category, msg)
+#define LOG_ERROR_CAT(category, msg) LOG_AT(Logger::Error, category, msg)
+#define LOG_WARNING_CAT(category, msg) LOG_AT(Logger::Warning, category, msg)
+
+// 门禁事件日志，doorId 和 eventType 在 jsonl 格式下写成独立字段，便于按门检索
+#define LOG_EVENT_CAT(level, category, msg, doorId, eventType) \
+    do { \
+        Logger *logger_ = Logger::instance(); \
+        if (logger_->isEnabled(level, category)) { \
+            logger_->logEvent(level, category, msg, doorId, eventType); \
+        } \
+    } while (0)
+
+// 定义 DOORSTATE_NO_DEBUG_LOG（qmake CONFIG+=no_debug_log）时 DEBUG 日志在编译期移除
+#ifdef DOORSTATE_NO_DEBUG_LOG
+#define LOG_DEBUG(msg) do { } while (0)
+#define LOG_DEBUG_CAT(category, msg) do { } while (0)
+#else
+#define LOG_DEBUG(msg) LOG_AT(Logger::Debug, Logger::General, msg)
+#define LOG_DEBUG_CAT(category, msg) LOG_AT(Logger::Debug, category, msg)
+#endif
 
 #endif // LOGGER_H
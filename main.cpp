@@ -1,34 +1,64 @@
 #include <QApplication>
+#include <QElapsedTimer>
+#include <QScopedPointer>
+#include <QStringList>
+#include <QTimer>
 #include "clientmanager.h"
 #include "logger.h"
 #include "configmanager.h"
 #include "systemtraymanager.h"
+#include "processinfo.h"
+#include "terminationsignals.h"
 #include <QMessageBox>
+#include <cstring>
 
 int main(int argc, char *argv[])
 {
-    QApplication app(argc, argv);
+    QElapsedTimer startupTimer;
+    startupTimer.start();
     
-    // 设置应用程序信息
-    QApplication::setApplicationName("DoorStateClient");
-    QApplication::setApplicationVersion("1.0.0");
-    QApplication::setOrganizationName("DoorControl");
-    
-    // 检查系统托盘是否可用
-    if (!QSystemTrayIcon::isSystemTrayAvailable()) {
-        QMessageBox::critical(nullptr, QObject::tr("系统托盘"),
-                            QObject::tr("检测不到系统托盘！"));
-        return 1;
+    // 各启动阶段耗时，日志系统就绪后统一输出
+    QElapsedTimer phaseTimer;
+    phaseTimer.start();
+    QStringList startupPhases;
+    auto markPhase = [&phaseTimer, &startupPhases](const QString &name) {
+        startupPhases << QString("%1 %2 ms").arg(name).arg(phaseTimer.restart());
+    };
+    
+    // 必须在创建应用对象之前确定运行模式：无界面模式只需要 QCoreApplication，
+    // 不加载平台插件和样式，也不要求系统托盘
+    bool headless = false;
+    QString configPath = "config.ini";
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--headless") == 0) {
+            headless = true;
+        } else if (argv[i][0] != '-') {
+            configPath = QString::fromLocal8Bit(argv[i]);
+        }
     }
     
-    // 防止应用在关闭最后一个窗口时退出（因为我们使用托盘）
-    QApplication::setQuitOnLastWindowClosed(false);
+    QScopedPointer<QCoreApplication> app(headless ? new QCoreApplication(argc, argv)
+                                                  : new QApplication(argc, argv));
     
-    // 初始化配置管理器
-    QString configPath = "config.ini";
-    if (argc > 1) {
-        configPath = QString::fromLocal8Bit(argv[1]);
+    // 设置应用程序信息
+    QCoreApplication::setApplicationName("DoorStateClient");
+    QCoreApplication::setApplicationVersion("1.0.0");
+    QCoreApplication::setOrganizationName("DoorControl");
+    
+    if (!headless) {
+        // 检查系统托盘是否可用
+        if (!QSystemTrayIcon::isSystemTrayAvailable()) {
+            QMessageBox::critical(nullptr, QObject::tr("系统托盘"),
+                                QObject::tr("检测不到系统托盘！可以使用 --headless 参数以无界面模式运行"));
+            return 1;
+        }
+        
+        // 防止应用在关闭最后一个窗口时退出（因为我们使用托盘）
+        QApplication::setQuitOnLastWindowClosed(false);
     }
+    markPhase("创建应用");
+    
+    // 初始化配置管理器
     ConfigManager::instance(configPath);
     
     // 初始化日志系统
@@ -36,25 +66,110 @@ int main(int argc, char *argv[])
     ConfigManager *config = ConfigManager::instance();
     logger->setLogPath(config->getLogPath());
     logger->setRetentionDays(config->getLogRetentionDays());
+    logger->setMaxFileSize(config->getLogMaxFileSize());
+    logger->setMaxFiles(config->getLogMaxFiles());
+    logger->setCompressRotated(config->getLogCompress());
+    logger->setFlushInterval(config->getLogFlushInterval());
+    logger->setFlushThreshold(config->getLogFlushThreshold());
+    logger->setQueueCapacity(config->getLogQueueCapacity());
+    logger->setAsyncEnabled(config->getLogAsync());
+    Logger::Level logLevel = Logger::levelFromString(config->getLogLevel());
+    logger->setLevel(logLevel);
+    logger->setCategoryLevel(Logger::Mqtt, Logger::levelFromString(config->getLogCategoryLevel("mqtt"), logLevel));
+    logger->setCategoryLevel(Logger::Ui, Logger::levelFromString(config->getLogCategoryLevel("ui"), logLevel));
+    logger->setCategoryLevel(Logger::Config, Logger::levelFromString(config->getLogCategoryLevel("config"), logLevel));
+    logger->setPayloadMaxBytes(config->getLogPayloadMaxBytes());
+    logger->setPayloadSampleRate(config->getLogPayloadSampleRate());
+    logger->setFormat(Logger::formatFromString(config->getLogFormat()));
+    logger->installCrashHandler();
+    markPhase("配置和日志");
+    
+    bool lazy = config->snapshot()->startupStrategy == "lazy";
     
     LOG_INFO("========================================");
-    LOG_INFO("DoorStateClient 启动");
-    LOG_INFO(QString("弹窗显示时间: %1 ms").arg(config->getNotificationDuration()));
-    LOG_INFO(QString("通知音量: %1").arg(config->getNotificationSoundVolume()));
-    LOG_INFO(QString("通知音频路径: %1").arg(config->getNotificationSoundPath()));
-    LOG_INFO(QString("通知音频循环模式: %1").arg(config->getNotificationSoundLoop()));
+    LOG_INFO(QString("DoorStateClient 启动%1").arg(headless ? "（无界面模式）" : ""));
+    if (!headless) {
+        LOG_INFO_CAT(Logger::Config, QString("启动策略: %1").arg(lazy ? "lazy" : "prewarm"));
+    }
+    LOG_INFO_CAT(Logger::Config, QString("弹窗显示时间: %1 ms").arg(config->getNotificationDuration()));
+    LOG_INFO_CAT(Logger::Config, QString("通知音量: %1").arg(config->getNotificationSoundVolume()));
+    LOG_INFO_CAT(Logger::Config, QString("通知音频路径: %1").arg(config->getNotificationSoundPath()));
+    LOG_INFO_CAT(Logger::Config, QString("通知音频循环模式: %1").arg(config->getNotificationSoundLoop()));
     LOG_INFO("========================================");
     
     // 创建并启动客户端管理器
-    ClientManager manager;
+    ClientManager manager(headless);
+    markPhase("客户端组件");
+    
+    // 记录从进程启动到第一次连接成功的时间
+    QObject::connect(manager.mqtt(), &MqttClient::connected, app.data(), [&startupTimer]() {
+        static bool reported = false;
+        if (!reported) {
+            reported = true;
+            LOG_INFO(QString("启动到 MQTT 连接成功: %1 ms").arg(startupTimer.elapsed()));
+        }
+    });
+    QObject::connect(manager.mqtt(), &MqttClient::syncFinished, app.data(), [&startupTimer](int messageCount, int durationMs) {
+        static bool reported = false;
+        if (!reported) {
+            reported = true;
+            LOG_INFO(QString("启动到状态同步完成: %1 ms（同步 %2 条消息，%3 ms）")
+                     .arg(startupTimer.elapsed())
+                     .arg(messageCount)
+                     .arg(durationMs));
+        }
+    });
     manager.start();
+    markPhase("开始连接");
     
-    // 创建并显示系统托盘
-    SystemTrayManager trayManager(&manager);
-    trayManager.show();
+    // 创建并显示系统托盘（无界面模式不创建）；lazy 策略下延后到事件循环开始之后
+    QScopedPointer<SystemTrayManager> trayManager;
+    auto createTray = [&trayManager, &manager]() {
+        trayManager.reset(new SystemTrayManager(&manager));
+        trayManager->show();
+    };
+    if (!headless) {
+        if (lazy) {
+            QTimer::singleShot(0, app.data(), [createTray, &startupTimer]() {
+                QElapsedTimer trayTimer;
+                trayTimer.start();
+                createTray();
+                LOG_INFO(QString("系统托盘已创建，耗时 %1 ms（启动后 %2 ms）")
+                         .arg(trayTimer.elapsed())
+                         .arg(startupTimer.elapsed()));
+            });
+        } else {
+            createTray();
+            markPhase("系统托盘");
+        }
+    }
     
     LOG_INFO("客户端已启动，等待门禁事件...");
-    LOG_INFO("程序运行在系统托盘中");
+    LOG_INFO(headless ? "程序以无界面模式运行" : "程序运行在系统托盘中");
+    
+    qint64 rss = ProcessInfo::residentMemoryBytes();
+    LOG_INFO(QString("启动耗时: %1 ms, 常驻内存: %2")
+             .arg(startupTimer.elapsed())
+             .arg(rss >= 0 ? QString("%1 MB").arg(rss / (1024.0 * 1024.0), 0, 'f', 1) : QString("未知")));
+    LOG_INFO(QString("启动阶段: %1").arg(startupPhases.join(", ")));
+    
+    // 终止信号走正常退出流程：无界面模式没有托盘菜单可以退出，直接结束进程会跳过日志刷盘、
+    // MQTT 断开和本地套接字清理
+    TerminationSignals terminationSignals;
+    QObject::connect(&terminationSignals, &TerminationSignals::terminationRequested, app.data(),
+                     [](const QString &reason) {
+        LOG_INFO(QString("%1，准备退出").arg(reason));
+        QCoreApplication::quit();
+    });
+    if (!terminationSignals.install()) {
+        LOG_WARNING("终止信号处理安装失败，结束进程时不会执行退出清理");
+    }
+    
+    int exitCode = app->exec();
+    
+    LOG_INFO("DoorStateClient 退出");
+    // 退出前写完异步队列中的日志
+    logger->shutdown();
     
-    return app.exec();
+    return exitCode;
 }
@@ -0,0 +1,195 @@
+#include "metricsserver.h"
+#include "clientmanager.h"
+#include "logger.h"
+#include "latencyhistogram.h"
+#include "processinfo.h"
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QHostAddress>
+
+namespace {
+
+const int MaxRequestSize = 8192;
+
+void appendMetric(QByteArray *out, const char *name, const char *type, const char *help, double value)
+{
+    out->append("# HELP ").append(name).append(' ').append(help).append('\n');
+    out->append("# TYPE ").append(name).append(' ').append(type).append('\n');
+    out->append(name).append(' ').append(QByteArray::number(value, 'g', 15)).append('\n');
+}
+
+} // namespace
+
+MetricsServer::MetricsServer(ClientManager *manager, QObject *parent)
+    : QObject(parent)
+    , m_manager(manager)
+    , m_server(nullptr)
+{
+}
+
+MetricsServer::~MetricsServer()
+{
+    setEnabled(false, 0);
+}
+
+void MetricsServer::setEnabled(bool enabled, quint16 port)
+{
+    if (enabled && m_server && m_server->serverPort() == port) {
+        return;
+    }
+    
+    if (m_server) {
+        m_server->close();
+        delete m_server;
+        m_server = nullptr;
+        LOG_INFO("监控接口已关闭");
+    }
+    if (!enabled) {
+        return;
+    }
+    
+    m_server = new QTcpServer(this);
+    // 只绑定回环地址，不对外暴露
+    if (!m_server->listen(QHostAddress::LocalHost, port)) {
+        LOG_ERROR(QString("监控接口监听失败，端口 %1: %2").arg(port).arg(m_server->errorString()));
+        delete m_server;
+        m_server = nullptr;
+        return;
+    }
+    connect(m_server, &QTcpServer::newConnection, this, [this]() {
+        onNewConnection();
+    });
+    LOG_INFO(QString("监控接口已启动: http://127.0.0.1:%1/metrics").arg(port));
+}
+
+bool MetricsServer::isListening() const
+{
+    return m_server && m_server->isListening();
+}
+
+void MetricsServer::onNewConnection()
+{
+    while (QTcpSocket *socket = m_server->nextPendingConnection()) {
+        m_requests.insert(socket, QByteArray());
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() {
+            onReadyRead(socket);
+        });
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            m_requests.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void MetricsServer::onReadyRead(QTcpSocket *socket)
+{
+    QByteArray &request = m_requests[socket];
+    request.append(socket->readAll());
+    
+    int headerEnd = request.indexOf("\r\n\r\n");
+    if (headerEnd < 0) {
+        if (request.size() > MaxRequestSize) {
+            socket->abort();
+        }
+        return;
+    }
+    
+    // 只看请求行，例如 "GET /metrics HTTP/1.1"
+    QList<QByteArray> requestLine = request.left(request.indexOf("\r\n")).split(' ');
+    QByteArray method = requestLine.value(0);
+    QByteArray path = requestLine.value(1);
+    
+    QByteArray status = "200 OK";
+    QByteArray body;
+    if (method != "GET") {
+        status = "405 Method Not Allowed";
+    } else if (path == "/metrics" || path.startsWith("/metrics?")) {
+        body = render();
+    } else {
+        status = "404 Not Found";
+    }
+    
+    QByteArray response = "HTTP/1.1 " + status + "\r\n"
+            "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+            "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+            "Connection: close\r\n\r\n" + body;
+    m_requests.remove(socket);
+    socket->write(response);
+    socket->disconnectFromHost();
+}
+
+QByteArray MetricsServer::render() const
+{
+    QByteArray out;
+    out.reserve(8192);
+    
+    const MqttClient *mqtt = m_manager->mqtt();
+    appendMetric(&out, "doorstate_mqtt_connected", "gauge", "1 if the MQTT client is connected", mqtt->isConnected() ? 1 : 0);
+    appendMetric(&out, "doorstate_mqtt_messages_received_total", "counter", "MQTT messages received", mqtt->receivedCount());
+    appendMetric(&out, "doorstate_mqtt_messages_delivered_total", "counter", "MQTT messages passed to handlers", mqtt->deliveredCount());
+    appendMetric(&out, "doorstate_mqtt_parse_failures_total", "counter", "Messages that could not be parsed as door events", mqtt->parseFailureCount());
+    appendMetric(&out, "doorstate_mqtt_duplicates_total", "counter", "Duplicate messages dropped", mqtt->duplicateCount());
+    appendMetric(&out, "doorstate_mqtt_recovered_total", "counter", "Events recovered after reconnect", mqtt->recoveredCount());
+    appendMetric(&out, "doorstate_mqtt_reconnect_attempts_total", "counter", "MQTT reconnect attempts", mqtt->reconnectAttemptCount());
+    appendMetric(&out, "doorstate_mqtt_inbound_queue_depth", "gauge", "Messages waiting in the inbound buffer", mqtt->inboundQueueDepth());
+    appendMetric(&out, "doorstate_mqtt_overloaded", "gauge", "1 if the inbound buffer is above its high watermark", mqtt->isOverloaded() ? 1 : 0);
+    appendMetric(&out, "doorstate_mqtt_overload_drops_total", "counter", "Messages dropped by the inbound buffer", mqtt->overloadDropCount());
+    appendMetric(&out, "doorstate_mqtt_syncing", "gauge", "1 while state sync after connect is in progress", mqtt->isSyncing() ? 1 : 0);
+    if (mqtt->lastSyncDurationMs() >= 0) {
+        appendMetric(&out, "doorstate_mqtt_last_sync_seconds", "gauge", "Duration of the last state sync", mqtt->lastSyncDurationMs() / 1000.0);
+        appendMetric(&out, "doorstate_mqtt_last_sync_messages", "gauge", "Messages ingested during the last state sync", mqtt->lastSyncMessageCount());
+    }
+    appendMetric(&out, "doorstate_mqtt_reconnect_attempt", "gauge", "Current reconnect attempt, 0 when connected", mqtt->currentReconnectAttempt());
+    const QDateTime nextReconnect = mqtt->nextReconnectTime();
+    appendMetric(&out, "doorstate_mqtt_next_reconnect_timestamp_seconds", "gauge",
+                 "Unix time of the next scheduled reconnect, 0 when not waiting",
+                 nextReconnect.isValid() ? nextReconnect.toMSecsSinceEpoch() / 1000.0 : 0);
+    
+    const EventCoalescer *coalescer = m_manager->eventCoalescer();
+    appendMetric(&out, "doorstate_events_received_total", "counter", "Door events entering the coalescer", coalescer->receivedCount());
+    appendMetric(&out, "doorstate_events_coalesced_total", "counter", "Door events merged into another notification", coalescer->coalescedCount());
+    appendMetric(&out, "doorstate_events_emitted_total", "counter", "Door events emitted as notifications", coalescer->emittedCount());
+    appendMetric(&out, "doorstate_event_digests_total", "counter", "Burst digest notifications", coalescer->digestCount());
+    
+    appendMetric(&out, "doorstate_notifications_visible", "gauge", "Notifications currently on screen", m_manager->notificationQueueDepth());
+    appendMetric(&out, "doorstate_notifications_queued", "gauge", "Notifications waiting for a free slot", m_manager->notificationBacklog());
+    appendMetric(&out, "doorstate_notifications_dropped_total", "counter", "Queued notifications dropped because the queue was full", m_manager->droppedNotificationCount());
+    
+    Logger *logger = Logger::instance();
+    appendMetric(&out, "doorstate_log_queue_depth", "gauge", "Log records waiting to be written", logger->queueDepth());
+    appendMetric(&out, "doorstate_log_dropped_total", "counter", "Log records dropped because the queue was full", logger->droppedCount());
+    
+    qint64 rss = ProcessInfo::residentMemoryBytes();
+    if (rss >= 0) {
+        appendMetric(&out, "doorstate_process_resident_memory_bytes", "gauge", "Resident memory size", rss);
+    }
+    
+    const LatencyMonitor &latency = m_manager->latency();
+    out.append("# HELP doorstate_latency_seconds Door event latency by stage\n");
+    out.append("# TYPE doorstate_latency_seconds summary\n");
+    appendHistogram(&out, "transit", latency.transit());
+    appendHistogram(&out, "parse", latency.parse());
+    appendHistogram(&out, "dispatch", latency.dispatch());
+    appendHistogram(&out, "sound", latency.sound());
+    appendHistogram(&out, "end_to_end", latency.endToEnd());
+    appendHistogram(&out, "end_to_end_corrected", latency.endToEndCorrected());
+    appendMetric(&out, "doorstate_clock_skew_seconds", "gauge", "Estimated broker clock offset plus minimum network delay",
+                 latency.clockSkewMs() / 1000.0);
+    
+    return out;
+}
+
+void MetricsServer::appendHistogram(QByteArray *out, const char *stage, const LatencyHistogram &histogram)
+{
+    static const double quantiles[] = { 0.5, 0.9, 0.99 };
+    for (double quantile : quantiles) {
+        out->append("doorstate_latency_seconds{stage=\"").append(stage)
+                .append("\",quantile=\"").append(QByteArray::number(quantile))
+                .append("\"} ").append(QByteArray::number(histogram.percentile(quantile * 100) / 1e6, 'g', 9))
+                .append('\n');
+    }
+    out->append("doorstate_latency_seconds_sum{stage=\"").append(stage).append("\"} ")
+            .append(QByteArray::number(histogram.sum() / 1e6, 'g', 15)).append('\n');
+    out->append("doorstate_latency_seconds_count{stage=\"").append(stage).append("\"} ")
+            .append(QByteArray::number(histogram.count())).append('\n');
+}
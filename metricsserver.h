@@ -0,0 +1,39 @@
+#ifndef METRICSSERVER_H
+#define METRICSSERVER_H
+
+#include <QObject>
+#include <QHash>
+#include <QByteArray>
+
+class QTcpServer;
+class QTcpSocket;
+class ClientManager;
+class LatencyHistogram;
+
+// 监控接口：只监听本机回环地址的简易 HTTP 服务，GET /metrics 返回 Prometheus 文本格式
+// 只在被抓取时读取各组件的原子计数器，事件处理路径上不加锁也不做额外工作
+class MetricsServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MetricsServer(ClientManager *manager, QObject *parent = nullptr);
+    ~MetricsServer();
+    
+    // port 变化时重新监听；enabled 为 false 时关闭服务
+    void setEnabled(bool enabled, quint16 port);
+    bool isListening() const;
+    
+    QByteArray render() const;
+
+private:
+    void onNewConnection();
+    void onReadyRead(QTcpSocket *socket);
+    static void appendHistogram(QByteArray *out, const char *stage, const LatencyHistogram &histogram);
+    
+    ClientManager *m_manager;
+    QTcpServer *m_server;
+    QHash<QTcpSocket*, QByteArray> m_requests;  // 尚未读完请求头的连接
+};
+
+#endif // METRICSSERVER_H
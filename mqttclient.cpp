@@ -1,23 +1,92 @@
 #include "mqttclient.h"
 #include "logger.h"
-#include <QJsonDocument>
 #include <QtMqtt/QMqttMessage>
+#include <QtGlobal>
+#include <QRandomGenerator>
+#if QT_VERSION >= QT_VERSION_CHECK(6, 1, 0)
+#include <QNetworkInformation>
+#elif QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+#include <QNetworkConfigurationManager>
+#endif
+#include "latencyhistogram.h"
+
+namespace {
+const int DrainBatchSize = 64;  // 每批最多处理的消息数，批次之间让出事件循环
+}
 
 MqttClient::MqttClient(QObject *parent)
     : QObject(parent)
     , m_client(nullptr)
     , m_reconnectTimer(nullptr)
-    , m_subscription(nullptr)
+    , m_reconnectPolicy(nullptr)
     , m_port(1883)
     , m_autoReconnect(true)
     , m_manualDisconnect(false)
-    , m_reconnectInterval(5000) // 默认 5 秒重连间隔
     , m_maxReconnectAttempts(0) // 默认无限重连
     , m_currentReconnectAttempt(0)
+    , m_nextReconnectAtMs(0)
+    , m_connected(0)
+    , m_drainTimer(nullptr)
+    , m_rateLimit(0)
+    , m_rateTokens(0.0)
+    , m_rateRefilledAtUs(0)
+    , m_overloadDropsAtStart(0)
+    , m_syncEnabled(true)
+    , m_syncQuietMs(500)
+    , m_syncMaxMs(5000)
+    , m_syncTimer(nullptr)
+    , m_syncMessages(0)
+    , m_hasConnected(false)
+    , m_receivedCount(0)
+    , m_deliveredCount(0)
+    , m_duplicateCount(0)
+    , m_recoveredCount(0)
+    , m_parseFailureCount(0)
+    , m_reconnectAttemptCount(0)
+    , m_overloadDropCount(0)
+    , m_inboundDepth(0)
+    , m_overloaded(0)
+    , m_syncing(0)
+    , m_lastSyncDurationMs(-1)
+    , m_lastSyncMessages(0)
 {
     m_client = new QMqttClient(this);
     m_reconnectTimer = new QTimer(this);
     m_reconnectTimer->setSingleShot(true);
+    m_drainTimer = new QTimer(this);
+    m_drainTimer->setSingleShot(true);
+    connect(m_drainTimer, &QTimer::timeout, this, [this]() {
+        drainInbound();
+    });
+    m_syncTimer = new QTimer(this);
+    m_syncTimer->setSingleShot(true);
+    connect(m_syncTimer, &QTimer::timeout, this, [this]() {
+        finishSync(m_syncClock.elapsed() >= m_syncMaxMs ? "达到最长同步时间" : "消息已静默");
+    });
+    m_reconnectPolicy = new ExponentialReconnectPolicy(1000, 60000); // 默认 1 - 60 秒指数退避
+    
+    // 网络接口恢复时立即重连，不必等待退避时间结束
+    // Qt 5 使用 QNetworkConfigurationManager（5.15 起标为废弃，只在这里屏蔽废弃警告），
+    // Qt 6 中已移除，6.1 起改用 QNetworkInformation；6.0 不监听网络状态，只按退避时间重连
+#if QT_VERSION >= QT_VERSION_CHECK(6, 1, 0)
+    if (QNetworkInformation::load(QNetworkInformation::Feature::Reachability)) {
+        connect(QNetworkInformation::instance(), &QNetworkInformation::reachabilityChanged,
+                this, [this](QNetworkInformation::Reachability reachability) {
+            onOnlineStateChanged(reachability == QNetworkInformation::Reachability::Online);
+        });
+    } else {
+        LOG_INFO_CAT(Logger::Mqtt, "当前平台不支持网络状态检测，只按退避时间重连");
+    }
+#elif QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+QT_WARNING_PUSH
+QT_WARNING_DISABLE_DEPRECATED
+    QNetworkConfigurationManager *networkManager = new QNetworkConfigurationManager(this);
+    connect(networkManager, &QNetworkConfigurationManager::onlineStateChanged,
+            this, [this](bool isOnline) {
+        onOnlineStateChanged(isOnline);
+    });
+QT_WARNING_POP
+#endif
     
     // 使用新式信号槽语法
     connect(m_client, &QMqttClient::connected, this, &MqttClient::onConnected);
@@ -43,27 +112,84 @@ MqttClient::~MqttClient()
     if (m_client && m_client->state() == QMqttClient::Connected) {
         m_client->disconnectFromHost();
     }
+    delete m_reconnectPolicy;
 }
 
 void MqttClient::connectToHost(const QString &host, quint16 port)
 {
     if (m_client->state() == QMqttClient::Connected) {
-        LOG_WARNING("MQTT 客户端已连接");
+        LOG_WARNING_CAT(Logger::Mqtt, "MQTT 客户端已连接");
         return;
     }
     
     m_host = host;
     m_port = port;
     m_manualDisconnect = false;
-    m_currentReconnectAttempt = 0;
+    m_currentReconnectAttempt.store(0);
     
     m_client->setHostname(m_host);
     m_client->setPort(m_port);
     
-    LOG_INFO(QString("正在连接到 MQTT 服务器 %1:%2...").arg(m_host).arg(m_port));
+    LOG_INFO_CAT(Logger::Mqtt, QString("正在连接到 MQTT 服务器 %1:%2...").arg(m_host).arg(m_port));
     m_client->connectToHost();
 }
 
+void MqttClient::setClientId(const QString &clientId)
+{
+    if (clientId.isEmpty()) {
+        // 随机 ID，避免同一台机器上的多个实例互相踢下线
+        m_client->setClientId(QString("DoorStateClient-%1")
+                              .arg(QRandomGenerator::global()->generate64(), 16, 16, QChar('0')));
+        return;
+    }
+    m_client->setClientId(clientId);
+}
+
+void MqttClient::setCleanSession(bool cleanSession)
+{
+    m_client->setCleanSession(cleanSession);
+}
+
+void MqttClient::setDuplicateCapacity(int capacity)
+{
+    m_duplicates.setCapacity(capacity);
+}
+
+void MqttClient::setDuplicateWindow(int windowMs)
+{
+    m_duplicates.setWindow(windowMs);
+}
+
+void MqttClient::setInboundLimits(int capacity, int highWatermark, int lowWatermark)
+{
+    bool wasOverloaded = m_inbound.isOverloaded();
+    m_inbound.setLimits(capacity, highWatermark, lowWatermark);
+    m_inboundDepth.store(m_inbound.size());
+    updateOverloadState(wasOverloaded);
+}
+
+void MqttClient::setInboundPolicy(InboundBuffer::Policy policy, int sampleEvery)
+{
+    m_inbound.setPolicy(policy, sampleEvery);
+}
+
+void MqttClient::setSyncWindow(bool enabled, int quietMs, int maxMs)
+{
+    m_syncEnabled = enabled;
+    m_syncQuietMs = qMax(10, quietMs);
+    m_syncMaxMs = qMax(m_syncQuietMs, maxMs);
+    if (!enabled && m_syncing.load()) {
+        finishSync("同步已关闭");
+    }
+}
+
+void MqttClient::setInboundRateLimit(int messagesPerSecond)
+{
+    m_rateLimit = qMax(0, messagesPerSecond);
+    m_rateTokens = m_rateLimit;
+    m_rateRefilledAtUs = LatencyHistogram::monotonicUs();
+}
+
 void MqttClient::disconnectFromHost()
 {
     m_manualDisconnect = true; // 标记为手动断开
@@ -72,83 +198,182 @@ void MqttClient::disconnectFromHost()
     if (m_reconnectTimer && m_reconnectTimer->isActive()) {
         m_reconnectTimer->stop();
     }
+    m_nextReconnectAtMs.store(0);
     
     if (m_client->state() == QMqttClient::Connected) {
-        LOG_INFO("断开 MQTT 连接");
+        LOG_INFO_CAT(Logger::Mqtt, "断开 MQTT 连接");
         m_client->disconnectFromHost();
     }
 }
 
 bool MqttClient::isConnected() const
 {
-    return m_client && m_client->state() == QMqttClient::Connected;
+    // 由 onConnected/onDisconnected 维护，其他线程读取时不访问 QMqttClient
+    return m_connected.load() != 0;
 }
 
-void MqttClient::subscribe(const QString &topic)
+bool MqttClient::addSubscription(const QString &filter, quint8 qos, MessageHandler handler)
 {
-    if (m_client->state() != QMqttClient::Connected) {
-        LOG_WARNING(QString("MQTT 未连接，无法订阅主题: %1").arg(topic));
-        m_subscribeTopic = topic; // 保存主题，连接后自动订阅
-        return;
+    if (!TopicRouter::isValidFilter(filter)) {
+        LOG_ERROR_CAT(Logger::Mqtt, QString("无效的 MQTT 主题过滤器: %1").arg(filter));
+        return false;
     }
+    qos = qMin<quint8>(qos, 2);
     
-    m_subscribeTopic = topic;
-    m_subscription = m_client->subscribe(topic, 0);
+    // 同一过滤器只保留一条记录，重复添加只更新 QoS 和处理函数
+    int routeId = m_routeByFilter.value(filter, -1);
+    if (routeId >= 0) {
+        Route &route = m_routes[routeId];
+        bool qosChanged = route.qos != qos;
+        route.qos = qos;
+        route.handler = handler;
+        if (qosChanged && route.subscription && isConnected()) {
+            subscribeRoute(routeId);
+        }
+        return true;
+    }
     
-    if (!m_subscription) {
-        LOG_ERROR(QString("MQTT 订阅失败，主题: %1").arg(topic));
+    Route route;
+    route.filter = filter;
+    route.qos = qos;
+    route.handler = handler;
+    route.subscription = nullptr;
+    route.active = true;
+    routeId = m_routes.size();
+    m_routes.append(route);
+    m_routeByFilter.insert(filter, routeId);
+    m_router.addRoute(filter, routeId);
+    
+    if (isConnected()) {
+        subscribeRoute(routeId);
+    } else {
+        LOG_INFO_CAT(Logger::Mqtt, QString("MQTT 未连接，主题 %1 将在连接后订阅").arg(filter));
+    }
+    return true;
+}
+
+void MqttClient::removeSubscription(const QString &filter)
+{
+    int routeId = m_routeByFilter.value(filter, -1);
+    if (routeId < 0) {
         return;
     }
+    m_routeByFilter.remove(filter);
     
-    // 使用 lambda 表达式处理消息接收
-    connect(m_subscription, &QMqttSubscription::messageReceived, 
-            this, [this](const QMqttMessage &msg) {
-        onMessageReceived(msg.payload(), msg.topic());
-    });
+    Route &route = m_routes[routeId];
+    route.active = false;
+    route.handler = MessageHandler();
+    m_router.removeRoute(filter, routeId);
     
-    LOG_INFO(QString("MQTT 已订阅主题: %1").arg(topic));
+    if (route.subscription) {
+        disconnect(route.subscription, nullptr, this, nullptr);
+        route.subscription = nullptr;
+    }
+    if (isConnected()) {
+        m_client->unsubscribe(filter);
+        LOG_INFO_CAT(Logger::Mqtt, QString("MQTT 已取消订阅主题: %1").arg(filter));
+    }
+}
+    
+QStringList MqttClient::subscriptions() const
+{
+    QStringList filters;
+    for (const Route &route : m_routes) {
+        if (route.active) {
+            filters.append(route.filter);
+        }
+    }
+    return filters;
+}
+    
+void MqttClient::subscribe(const QString &topic, quint8 qos)
+{
+    addSubscription(topic, qos);
 }
 
 void MqttClient::unsubscribe(const QString &topic)
 {
-    if (m_client->state() != QMqttClient::Connected) {
-        LOG_WARNING("MQTT 未连接，无法取消订阅");
+    removeSubscription(topic);
+}
+
+void MqttClient::subscribeRoute(int routeId)
+{
+    Route &route = m_routes[routeId];
+    QMqttSubscription *subscription = m_client->subscribe(route.filter, route.qos);
+    
+    if (!subscription) {
+        LOG_ERROR_CAT(Logger::Mqtt, QString("MQTT 订阅失败，主题: %1").arg(route.filter));
         return;
     }
     
-    m_client->unsubscribe(topic);
-    LOG_INFO(QString("MQTT 已取消订阅主题: %1").arg(topic));
+    // QMqttClient 对同一过滤器会返回同一个订阅对象，已连接过的不再重复连接信号，
+    // 避免重连后同一条消息触发多次处理
+    if (subscription != route.subscription) {
+        if (route.subscription) {
+            disconnect(route.subscription, nullptr, this, nullptr);
+        }
+        route.subscription = subscription;
+        connect(subscription, &QMqttSubscription::messageReceived,
+                this, [this, routeId](const QMqttMessage &msg) {
+            onSubscriptionMessage(routeId, msg);
+        });
+    }
+    
+    LOG_INFO_CAT(Logger::Mqtt, QString("MQTT 已订阅主题: %1 (QoS %2)").arg(route.filter).arg(route.qos));
 }
 
 void MqttClient::onConnected()
 {
-    m_currentReconnectAttempt = 0; // 重置重连计数
+    m_connected.store(1);
+    m_currentReconnectAttempt.store(0); // 重置重连计数
+    m_nextReconnectAtMs.store(0);
     m_autoReconnect = true; // 启用自动重连
+    if (m_hasConnected) {
+        m_reconnectedAt = QDateTime::currentDateTime();
+    }
+    m_hasConnected = true;
     
-    LOG_INFO("MQTT 客户端已连接");
+    LOG_INFO_CAT(Logger::Mqtt, QString("MQTT 客户端已连接 (ID: %1, %2)")
+             .arg(m_client->clientId())
+             .arg(m_client->cleanSession() ? "清除会话" : "持久会话"));
     emit connected();
     
-    // 如果有保存的订阅主题，自动订阅
-    if (!m_subscribeTopic.isEmpty()) {
-        subscribe(m_subscribeTopic);
+    // 订阅之前进入同步阶段，订阅后到达的保留消息和积压消息都只更新状态
+    if (m_syncEnabled) {
+        beginSync();
+    }
+    
+    // 按注册表重新订阅全部主题
+    for (int routeId = 0; routeId < m_routes.size(); ++routeId) {
+        if (m_routes.at(routeId).active) {
+            subscribeRoute(routeId);
+        }
     }
 }
 
 void MqttClient::onDisconnected()
 {
-    LOG_WARNING("MQTT 客户端已断开");
+    LOG_WARNING_CAT(Logger::Mqtt, "MQTT 客户端已断开");
+    m_connected.store(0);
+    if (m_syncing.load()) {
+        finishSync("连接已断开");
+    }
     emit disconnected();
     
     // 如果不是手动断开且启用了自动重连，则尝试重连
     if (!m_manualDisconnect && m_autoReconnect) {
-        if (m_maxReconnectAttempts == 0 || m_currentReconnectAttempt < m_maxReconnectAttempts) {
-            m_currentReconnectAttempt++;
-            LOG_INFO(QString("将在 %1 秒后尝试第 %2 次重连...")
-                     .arg(m_reconnectInterval / 1000)
-                     .arg(m_currentReconnectAttempt));
-            m_reconnectTimer->start(m_reconnectInterval);
+        int attempt = m_currentReconnectAttempt.load();
+        if (m_maxReconnectAttempts == 0 || attempt < m_maxReconnectAttempts) {
+            attempt++;
+            m_currentReconnectAttempt.store(attempt);
+            int delay = m_reconnectPolicy->nextDelay(attempt);
+            m_nextReconnectAtMs.store(QDateTime::currentMSecsSinceEpoch() + delay);
+            LOG_INFO_CAT(Logger::Mqtt, QString("将在 %1 毫秒后尝试第 %2 次重连...")
+                     .arg(delay)
+                     .arg(attempt));
+            m_reconnectTimer->start(delay);
         } else {
-            LOG_ERROR(QString("已达到最大重连次数 (%1)，停止重连").arg(m_maxReconnectAttempts));
+            LOG_ERROR_CAT(Logger::Mqtt, QString("已达到最大重连次数 (%1)，停止重连").arg(m_maxReconnectAttempts));
         }
     }
 }
@@ -186,53 +411,196 @@ void MqttClient::onErrorChanged(QMqttClient::ClientError error)
             break;
     }
     
-    LOG_ERROR(QString("MQTT 错误: %1").arg(errorStr));
+    LOG_ERROR_CAT(Logger::Mqtt, QString("MQTT 错误: %1").arg(errorStr));
     emit errorOccurred(errorStr);
 }
 
 void MqttClient::onStateChanged(QMqttClient::ClientState state)
 {
-    QString stateStr;
+    // 状态名称只在 DEBUG 级别启用时才会生成
+    LOG_DEBUG_CAT(Logger::Mqtt, QString("MQTT 状态变化: %1").arg(stateToString(state)));
+}
+
+QString MqttClient::stateToString(QMqttClient::ClientState state)
+{
     switch (state) {
         case QMqttClient::Disconnected:
-            stateStr = "已断开";
-            break;
+            return "已断开";
         case QMqttClient::Connecting:
-            stateStr = "正在连接";
-            break;
+            return "正在连接";
         case QMqttClient::Connected:
-            stateStr = "已连接";
-            break;
+            return "已连接";
         default:
-            stateStr = "未知状态";
-            break;
+            return "未知状态";
     }
-    
-    LOG_DEBUG(QString("MQTT 状态变化: %1").arg(stateStr));
 }
 
 void MqttClient::attemptReconnect()
 {
     if (m_client->state() == QMqttClient::Connected) {
-        LOG_INFO("MQTT 已连接，取消重连");
+        LOG_INFO_CAT(Logger::Mqtt, "MQTT 已连接，取消重连");
         return;
     }
+    m_nextReconnectAtMs.store(0);
     
-    LOG_INFO(QString("正在尝试重连到 MQTT 服务器 %1:%2 (第 %3 次尝试)...")
+    LOG_INFO_CAT(Logger::Mqtt, QString("正在尝试重连到 MQTT 服务器 %1:%2 (第 %3 次尝试)...")
              .arg(m_host)
              .arg(m_port)
-             .arg(m_currentReconnectAttempt));
+             .arg(m_currentReconnectAttempt.load()));
     
-    emit reconnecting(m_currentReconnectAttempt);
+    m_reconnectAttemptCount.fetchAndAddRelaxed(1);
+    emit reconnecting(m_currentReconnectAttempt.load());
     
     m_client->setHostname(m_host);
     m_client->setPort(m_port);
     m_client->connectToHost();
 }
 
+void MqttClient::onOnlineStateChanged(bool isOnline)
+{
+    LOG_INFO_CAT(Logger::Mqtt, QString("网络状态变化: %1").arg(isOnline ? "在线" : "离线"));
+    
+    // 之前的失败多半是网络导致的，网络恢复后重新开始退避并立即重连
+    if (isOnline && m_reconnectTimer->isActive()) {
+        m_reconnectTimer->stop();
+        m_currentReconnectAttempt.store(1);
+        attemptReconnect();
+    }
+}
+
 void MqttClient::setReconnectInterval(int intervalMs)
 {
-    m_reconnectInterval = intervalMs;
+    setReconnectPolicy(new FixedReconnectPolicy(intervalMs));
+}
+
+void MqttClient::setReconnectPolicy(ReconnectPolicy *policy)
+{
+    if (!policy || policy == m_reconnectPolicy) {
+        return;
+    }
+    delete m_reconnectPolicy;
+    m_reconnectPolicy = policy;
+}
+
+int MqttClient::currentReconnectAttempt() const
+{
+    return m_currentReconnectAttempt.load();
+}
+
+QDateTime MqttClient::nextReconnectTime() const
+{
+    qint64 atMs = m_nextReconnectAtMs.load();
+    return atMs > 0 ? QDateTime::fromMSecsSinceEpoch(atMs) : QDateTime();
+}
+
+QString MqttClient::reconnectPolicyName() const
+{
+    return m_reconnectPolicy->name();
+}
+
+quint64 MqttClient::receivedCount() const
+{
+    return m_receivedCount.load();
+}
+
+quint64 MqttClient::deliveredCount() const
+{
+    return m_deliveredCount.load();
+}
+
+quint64 MqttClient::duplicateCount() const
+{
+    return m_duplicateCount.load();
+}
+
+quint64 MqttClient::recoveredCount() const
+{
+    return m_recoveredCount.load();
+}
+
+quint64 MqttClient::parseFailureCount() const
+{
+    return m_parseFailureCount.load();
+}
+
+quint64 MqttClient::reconnectAttemptCount() const
+{
+    return m_reconnectAttemptCount.load();
+}
+
+quint64 MqttClient::overloadDropCount() const
+{
+    return m_overloadDropCount.load();
+}
+
+int MqttClient::inboundQueueDepth() const
+{
+    return m_inboundDepth.load();
+}
+
+bool MqttClient::isOverloaded() const
+{
+    return m_overloaded.load() != 0;
+}
+
+bool MqttClient::isSyncing() const
+{
+    return m_syncing.load() != 0;
+}
+
+int MqttClient::lastSyncDurationMs() const
+{
+    return m_lastSyncDurationMs.load();
+}
+
+int MqttClient::lastSyncMessageCount() const
+{
+    return m_lastSyncMessages.load();
+}
+
+void MqttClient::beginSync()
+{
+    m_syncing.store(1);
+    m_syncMessages = 0;
+    m_syncClock.start();
+    m_syncTimer->start(m_syncQuietMs);
+    LOG_DEBUG_CAT(Logger::Mqtt, "开始同步保留消息和积压消息");
+}
+
+bool MqttClient::noteSyncMessage()
+{
+    if (!m_syncing.load()) {
+        return false;
+    }
+    
+    ++m_syncMessages;
+    qint64 remainingMs = m_syncMaxMs - m_syncClock.elapsed();
+    if (remainingMs <= 0) {
+        // 这条消息仍算作同步阶段，同步在处理完后结束
+        QTimer::singleShot(0, this, [this]() {
+            if (m_syncing.load()) {
+                finishSync("达到最长同步时间");
+            }
+        });
+        return true;
+    }
+    m_syncTimer->start(int(qMin<qint64>(m_syncQuietMs, remainingMs)));
+    return true;
+}
+
+void MqttClient::finishSync(const QString &reason)
+{
+    m_syncTimer->stop();
+    m_syncing.store(0);
+    
+    int durationMs = int(m_syncClock.elapsed());
+    m_lastSyncDurationMs.store(durationMs);
+    m_lastSyncMessages.store(m_syncMessages);
+    LOG_INFO_CAT(Logger::Mqtt, QString("状态同步完成（%1）: %2 条消息，耗时 %3 ms")
+             .arg(reason)
+             .arg(m_syncMessages)
+             .arg(durationMs));
+    emit syncFinished(m_syncMessages, durationMs);
 }
 
 void MqttClient::setMaxReconnectAttempts(int maxAttempts)
@@ -240,24 +608,249 @@ void MqttClient::setMaxReconnectAttempts(int maxAttempts)
     m_maxReconnectAttempts = maxAttempts;
 }
 
-void MqttClient::onMessageReceived(const QByteArray &message, const QMqttTopicName &topic)
+void MqttClient::onSubscriptionMessage(int routeId, const QMqttMessage &msg)
 {
-    QString topicStr = topic.name();
-    LOG_INFO(QString("MQTT 收到消息，主题: %1, 内容: %2")
-             .arg(topicStr)
-             .arg(QString::fromUtf8(message)));
+    qint64 receivedAtUs = LatencyHistogram::monotonicUs();
+    qint64 receivedAtMs = QDateTime::currentMSecsSinceEpoch();
+    
+    // 过滤器有重叠时同一条消息会从多个订阅到达，由最先送达的订阅处理一次；
+    // 不固定由某个 routeId 处理，订阅失败或 QoS 较低的过滤器不会让消息丢失
+    Q_UNUSED(routeId);
+    const QString topicStr = msg.topic().name();
+    const QVector<int> routeIds = m_router.match(topicStr);
+    if (routeIds.isEmpty() || isOverlapCopy(routeIds, topicStr, msg.payload())) {
+        return;
+    }
     
-    emit messageReceived(topicStr, message);
+    bool stateOnly = noteSyncMessage() || msg.retain();
+    enqueueMessage(routeIds, topicStr, msg.payload(), msg.duplicate(), stateOnly, receivedAtUs, receivedAtMs);
+}
+
+bool MqttClient::isOverlapCopy(const QVector<int> &routeIds, const QString &topic, const QByteArray &payload)
+{
+    // 会送达这条消息的订阅数：已订阅成功、仍然有效的路由
+    int deliveries = 0;
+    for (int id : routeIds) {
+        const Route &route = m_routes.at(id);
+        if (route.active && route.subscription && route.subscription->state() == QMqttSubscription::Subscribed) {
+            ++deliveries;
+        }
+    }
+    if (deliveries <= 1 && m_overlapCopies.isEmpty()) {
+        return false;
+    }
+    
+    qint64 now = LatencyHistogram::monotonicUs();
+    for (QHash<quint64, OverlapCopies>::iterator it = m_overlapCopies.begin(); it != m_overlapCopies.end();) {
+        if (it->expiresAtUs <= now) {
+            it = m_overlapCopies.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    
+    quint64 key = DuplicateFilter::fingerprint(topic, payload);
+    QHash<quint64, OverlapCopies>::iterator it = m_overlapCopies.find(key);
+    if (it != m_overlapCopies.end()) {
+        if (--it->remaining <= 0) {
+            m_overlapCopies.erase(it);
+        }
+        return true;
+    }
+    
+    // 副本通常紧接着到达，1 秒内没有到达的不再等待
+    if (deliveries > 1) {
+        OverlapCopies copies;
+        copies.remaining = deliveries - 1;
+        copies.expiresAtUs = now + 1000000;
+        m_overlapCopies.insert(key, copies);
+    }
+    return false;
+}
+
+void MqttClient::injectMessage(const QString &topic, const QByteArray &payload)
+{
+    qint64 receivedAtUs = LatencyHistogram::monotonicUs();
+    qint64 receivedAtMs = QDateTime::currentMSecsSinceEpoch();
     
-    // 解析 JSON 消息
-    QJsonDocument doc = QJsonDocument::fromJson(message);
-    if (!doc.isObject()) {
-        LOG_WARNING("MQTT 消息不是有效的 JSON 对象");
+    const QVector<int> routeIds = m_router.match(topic);
+    if (routeIds.isEmpty()) {
         return;
     }
     
-    QJsonObject obj = doc.object();
+    enqueueMessage(routeIds, topic, payload, false, noteSyncMessage(), receivedAtUs, receivedAtMs);
+}
+
+void MqttClient::enqueueMessage(const QVector<int> &routeIds, const QString &topic, const QByteArray &payload,
+                                bool duplicateFlag, bool stateOnly, qint64 receivedAtUs, qint64 receivedAtMs)
+{
+    m_receivedCount.fetchAndAddRelaxed(1);
+    emit messageReceived(topic, payload);
+    
+    // 快速路径：没有积压且有配额时直接处理，正常速率下不经过队列；只更新状态的消息不占用配额
+    if (m_inbound.isEmpty() && (stateOnly || takeRateToken())) {
+        processMessage(routeIds, topic, payload, duplicateFlag, stateOnly, receivedAtUs, receivedAtMs);
+        return;
+    }
+    
+    InboundBuffer::Message message;
+    message.routeIds = routeIds;
+    message.topic = topic;
+    message.payload = payload;
+    message.duplicateFlag = duplicateFlag;
+    message.stateOnly = stateOnly;
+    message.receivedAtUs = receivedAtUs;
+    message.receivedAtMs = receivedAtMs;
+    
+    bool wasOverloaded = m_inbound.isOverloaded();
+    int dropped = m_inbound.push(message);
+    if (dropped > 0) {
+        m_overloadDropCount.fetchAndAddRelaxed(dropped);
+    }
+    m_inboundDepth.store(m_inbound.size());
+    updateOverloadState(wasOverloaded);
+    
+    if (!m_drainTimer->isActive()) {
+        m_drainTimer->start(0);
+    }
+}
+
+void MqttClient::drainInbound()
+{
+    bool wasOverloaded = m_inbound.isOverloaded();
+    InboundBuffer::Message message;
+    int processed = 0;
+    bool throttled = false;
+    while (processed < DrainBatchSize && !m_inbound.isEmpty()) {
+        if (!m_inbound.head().stateOnly && !takeRateToken()) {
+            throttled = true;
+            break;
+        }
+        m_inbound.pop(&message);
+        processMessage(message.routeIds, message.topic, message.payload, message.duplicateFlag,
+                       message.stateOnly, message.receivedAtUs, message.receivedAtMs);
+        ++processed;
+    }
+    m_inboundDepth.store(m_inbound.size());
+    updateOverloadState(wasOverloaded);
+    
+    if (m_inbound.isEmpty()) {
+        return;
+    }
+    
+    // 配额用完时等到下一个令牌，否则让出事件循环后继续处理下一批
+    int delayMs = 0;
+    if (throttled) {
+        delayMs = qMax(1, int((1.0 - m_rateTokens) * 1000.0 / m_rateLimit) + 1);
+    }
+    m_drainTimer->start(delayMs);
+}
+
+bool MqttClient::takeRateToken()
+{
+    if (m_rateLimit <= 0) {
+        return true;
+    }
+    
+    qint64 now = LatencyHistogram::monotonicUs();
+    m_rateTokens = qMin(double(m_rateLimit), m_rateTokens + (now - m_rateRefilledAtUs) * m_rateLimit / 1e6);
+    m_rateRefilledAtUs = now;
+    if (m_rateTokens < 1.0) {
+        return false;
+    }
+    m_rateTokens -= 1.0;
+    return true;
+}
+
+void MqttClient::updateOverloadState(bool wasOverloaded)
+{
+    bool overloaded = m_inbound.isOverloaded();
+    if (overloaded == wasOverloaded) {
+        return;
+    }
+    
+    m_overloaded.store(overloaded ? 1 : 0);
+    if (overloaded) {
+        m_overloadDropsAtStart = m_overloadDropCount.load();
+        LOG_WARNING_CAT(Logger::Mqtt, QString("入站消息积压 %1 条，进入过载保护").arg(m_inbound.size()));
+    } else {
+        LOG_INFO_CAT(Logger::Mqtt, QString("入站消息积压回落到 %1 条，退出过载保护，期间丢弃 %2 条消息")
+                     .arg(m_inbound.size())
+                     .arg(m_overloadDropCount.load() - m_overloadDropsAtStart));
+    }
+    emit overloadChanged(overloaded, m_inbound.size());
+}
+
+void MqttClient::processMessage(const QVector<int> &routeIds, const QString &topic, const QByteArray &payload,
+                                bool duplicateFlag, bool stateOnly, qint64 receivedAtUs, qint64 receivedAtMs)
+{
+    onMessageReceived(payload, topic);
+    
+    // QoS 1 重发（DUP 标志）或重连后同步阶段补发的消息只处理一次；
+    // 正常实时收到的相同内容不过滤，重复的按钮事件等照常通知
+    bool redelivery = duplicateFlag || stateOnly;
+    if (m_duplicates.isDuplicate(topic, payload, redelivery)) {
+        m_duplicateCount.fetchAndAddRelaxed(1);
+        LOG_DEBUG_CAT(Logger::Mqtt, QString("丢弃重复消息，主题: %1%2")
+                  .arg(topic)
+                  .arg(duplicateFlag ? " (DUP)" : ""));
+        return;
+    }
     
-    // 发送门禁事件信号
-    emit doorEventReceived(obj);
+    m_deliveredCount.fetchAndAddRelaxed(1);
+    dispatch(routeIds, topic, payload, stateOnly, receivedAtUs, receivedAtMs);
+}
+
+void MqttClient::dispatch(const QVector<int> &routeIds, const QString &topic, const QByteArray &payload,
+                          bool stateOnly, qint64 receivedAtUs, qint64 receivedAtMs)
+{
+    bool parsed = false;
+    for (int routeId : routeIds) {
+        const Route &route = m_routes.at(routeId);
+        if (route.handler) {
+            route.handler(topic, payload);
+            continue;
+        }
+        
+        // 默认处理函数：多个过滤器同时命中时也只解析一次
+        if (parsed) {
+            continue;
+        }
+        parsed = true;
+        
+        // 解析门禁事件：快速解析只提取已知字段，不支持的写法自动回退到 QJsonDocument
+        DoorEvent event;
+        if (!DoorEvent::fromPayload(payload, &event)) {
+            m_parseFailureCount.fetchAndAddRelaxed(1);
+            LOG_WARNING_CAT(Logger::Mqtt, "MQTT 消息不是有效的 JSON 对象");
+            continue;
+        }
+        event.topic = topic;
+        event.receivedAtMs = receivedAtMs;
+        event.receivedAtUs = receivedAtUs;
+        event.parsedAtUs = LatencyHistogram::monotonicUs();
+        
+        // 事件时间早于最近一次重连，说明是断线期间由服务端保留、重连后补发的
+        if (m_reconnectedAt.isValid() && event.dateTime.isValid() && event.dateTime < m_reconnectedAt) {
+            m_recoveredCount.fetchAndAddRelaxed(1);
+            LOG_INFO_CAT(Logger::Mqtt, QString("补收断线期间的门禁事件: %1").arg(event.timestamp));
+        }
+        
+        // 同步阶段和保留消息只更新门状态，不进入合并和通知流程
+        if (stateOnly) {
+            emit doorStateSynced(event);
+            continue;
+        }
+        
+        // 发送门禁事件信号
+        emit doorEventReceived(event);
+    }
+}
+
+void MqttClient::onMessageReceived(const QByteArray &message, const QString &topicStr)
+{
+    // 负载按 payload_max_bytes 截断/采样，级别被过滤时不做任何转换
+    LOG_INFO_CAT(Logger::Mqtt, QString("MQTT 收到消息，主题: %1, 内容: %2")
+             .arg(topicStr)
+             .arg(Logger::instance()->payloadPreview(message)));
 }
@@ -3,9 +3,25 @@
 
 #include <QObject>
 #include <QtMqtt/QMqttClient>
-#include <QJsonObject>
 #include <QTimer>
+#include <QVector>
+#include <QStringList>
+#include <QHash>
+#include <QPointer>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QAtomicInteger>
+#include <functional>
+#include "doorevent.h"
+#include "topicrouter.h"
+#include "reconnectpolicy.h"
+#include "duplicatefilter.h"
+#include "inboundbuffer.h"
 
+class QMqttMessage;
+
+// MQTT 客户端，由 ClientManager 移到独立的网络线程中运行
+// 修改状态的方法需要在该线程中调用（QMetaObject::invokeMethod），统计和状态查询可在任意线程调用
 class MqttClient : public QObject
 {
     Q_OBJECT
@@ -15,15 +31,66 @@ public:
     ~MqttClient();
     
     void connectToHost(const QString &host, quint16 port);
+    
+    // 会话参数，下次连接时生效；持久会话需要固定的客户端 ID
+    void setClientId(const QString &clientId);
+    void setCleanSession(bool cleanSession);
+    void setDuplicateCapacity(int capacity); // 0 表示不做重复过滤
+    void setDuplicateWindow(int windowMs);   // 指纹有效期
+    
+    // 入站缓冲：订阅回调只入队，消息按速率分批处理，处理之间让出事件循环
+    // 队列超过高水位时进入过载状态并按策略丢弃，回落到低水位后恢复
+    void setInboundLimits(int capacity, int highWatermark, int lowWatermark);
+    void setInboundPolicy(InboundBuffer::Policy policy, int sampleEvery);
+    void setInboundRateLimit(int messagesPerSecond); // 0 表示不限速
+    
+    // 同步阶段：连接（包括重连）后服务端推送的保留消息和积压消息只通过 doorStateSynced 更新门状态，
+    // 不进入通知流程；连续 quietMs 没有新消息或持续 maxMs 后结束，之后的消息才作为实时事件发出
+    // 带 retain 标志的消息任何时候都只更新状态
+    void setSyncWindow(bool enabled, int quietMs, int maxMs);
     void disconnectFromHost();
-    void subscribe(const QString &topic);
+    
+    // 主题处理函数，为空时按门禁事件解析并发出 doorEventReceived
+    typedef std::function<void(const QString &topic, const QByteArray &payload)> MessageHandler;
+    
+    // 订阅注册表：按过滤器去重，支持 + / # 通配符和每个主题单独的 QoS
+    // 未连接时只登记，连接（包括重连）后统一订阅
+    bool addSubscription(const QString &filter, quint8 qos = 0, MessageHandler handler = MessageHandler());
+    void removeSubscription(const QString &filter);
+    QStringList subscriptions() const;
+    
+    // 不经过网络，直接把一条消息送入与订阅消息相同的处理流程（路由、去重、解析）
+    // 用于基准测试和事件回放；主题不匹配任何订阅时忽略
+    void injectMessage(const QString &topic, const QByteArray &payload);
+    
+    void subscribe(const QString &topic, quint8 qos = 0);
     void unsubscribe(const QString &topic);
     
     bool isConnected() const;
     
     // 设置重连参数
-    void setReconnectInterval(int intervalMs);
+    void setReconnectInterval(int intervalMs); // 切换为固定间隔策略
+    void setReconnectPolicy(ReconnectPolicy *policy); // 接管 policy 的所有权
     void setMaxReconnectAttempts(int maxAttempts); // 0 表示无限重连
+    
+    // 重连状态，用于状态显示和监控
+    int currentReconnectAttempt() const;
+    QDateTime nextReconnectTime() const; // 未在等待重连时无效
+    QString reconnectPolicyName() const; // 只能在网络线程调用
+    
+    // 消息统计，计数器为原子类型，可在任意线程读取
+    quint64 receivedCount() const;    // 收到的消息数（去重之前）
+    quint64 deliveredCount() const;   // 交给处理函数的消息数
+    quint64 duplicateCount() const;   // 丢弃的重复消息数
+    quint64 recoveredCount() const;   // 重连后补收的、发生在断线期间的事件数
+    quint64 parseFailureCount() const; // 无法解析为门禁事件的消息数
+    quint64 reconnectAttemptCount() const; // 累计重连次数
+    quint64 overloadDropCount() const; // 入站缓冲丢弃的消息数
+    int inboundQueueDepth() const;     // 入站缓冲中等待处理的消息数
+    bool isOverloaded() const;
+    bool isSyncing() const;
+    int lastSyncDurationMs() const;   // 最近一次同步耗时，还没有完成过同步时为 -1
+    int lastSyncMessageCount() const; // 最近一次同步收到的消息数
 
 signals:
     void connected();
@@ -31,7 +98,10 @@ signals:
     void errorOccurred(const QString &error);
     void messageReceived(const QString &topic, const QByteArray &message);
     void reconnecting(int attemptCount);
-    void doorEventReceived(const QJsonObject &eventData); // 门禁事件信号
+    void doorEventReceived(const DoorEvent &event); // 门禁事件信号
+    void overloadChanged(bool overloaded, int queuedMessages); // 入站缓冲进入或退出过载状态
+    void doorStateSynced(const DoorEvent &event);  // 同步阶段或保留消息中的门禁事件，只用于更新状态
+    void syncFinished(int messageCount, int durationMs);
 
 private slots:
     void onConnected();
@@ -39,21 +109,90 @@ private slots:
     void onErrorChanged(QMqttClient::ClientError error);
     void onStateChanged(QMqttClient::ClientState state);
     void attemptReconnect();
-    void onMessageReceived(const QByteArray &message, const QMqttTopicName &topic);
+    void onOnlineStateChanged(bool isOnline);
+    void onMessageReceived(const QByteArray &message, const QString &topic);
 
 private:
+    struct Route
+    {
+        QString filter;
+        quint8 qos;
+        MessageHandler handler;
+        QPointer<QMqttSubscription> subscription;  // 订阅对象由 QMqttClient 管理
+        bool active;
+    };
+    
+    static QString stateToString(QMqttClient::ClientState state);
+    void subscribeRoute(int routeId);
+    void onSubscriptionMessage(int routeId, const QMqttMessage &msg);
+    // 过滤器重叠时同一条消息会从多个订阅到达，返回 true 表示这是已处理消息的副本
+    bool isOverlapCopy(const QVector<int> &routeIds, const QString &topic, const QByteArray &payload);
+    void enqueueMessage(const QVector<int> &routeIds, const QString &topic, const QByteArray &payload,
+                        bool duplicateFlag, bool stateOnly, qint64 receivedAtUs, qint64 receivedAtMs);
+    // 同步阶段中每收到一条消息调用一次，返回 true 表示该消息属于同步阶段
+    bool noteSyncMessage();
+    void beginSync();
+    void finishSync(const QString &reason);
+    void drainInbound();
+    bool takeRateToken();
+    void updateOverloadState(bool wasOverloaded);
+    void processMessage(const QVector<int> &routeIds, const QString &topic, const QByteArray &payload,
+                        bool duplicateFlag, bool stateOnly, qint64 receivedAtUs, qint64 receivedAtMs);
+    void dispatch(const QVector<int> &routeIds, const QString &topic, const QByteArray &payload,
+                  bool stateOnly, qint64 receivedAtUs, qint64 receivedAtMs);
+    
     QMqttClient *m_client;
     QTimer *m_reconnectTimer;
-    QMqttSubscription *m_subscription;
+    ReconnectPolicy *m_reconnectPolicy;
     
     QString m_host;
     quint16 m_port;
-    QString m_subscribeTopic; // 订阅的主题
+    QVector<Route> m_routes;            // 下标即 routeId，移除的条目标记为 inactive
+    QHash<QString, int> m_routeByFilter; // 过滤器 -> routeId
+    TopicRouter m_router;
+    DuplicateFilter m_duplicates;
+    // 消息指纹 -> 还会从其他重叠订阅到达的副本数和过期时间（单调时钟，微秒）
+    struct OverlapCopies
+    {
+        int remaining;
+        qint64 expiresAtUs;
+    };
+    QHash<quint64, OverlapCopies> m_overlapCopies;
+    InboundBuffer m_inbound;
+    QTimer *m_drainTimer;
+    int m_rateLimit;
+    double m_rateTokens;          // 令牌桶，最多积累 1 秒的配额
+    qint64 m_rateRefilledAtUs;
+    quint64 m_overloadDropsAtStart; // 进入过载时的丢弃计数，退出时汇总本次丢弃数
+    
+    bool m_syncEnabled;
+    int m_syncQuietMs;
+    int m_syncMaxMs;
+    QTimer *m_syncTimer;        // 静默计时，超时即结束同步
+    QElapsedTimer m_syncClock;
+    int m_syncMessages;
     bool m_autoReconnect;
     bool m_manualDisconnect; // 标记是否为手动断开
-    int m_reconnectInterval;
     int m_maxReconnectAttempts;
-    int m_currentReconnectAttempt;
+    // 状态字段会被托盘和监控接口从其他线程读取，使用原子类型
+    QAtomicInt m_currentReconnectAttempt;
+    QAtomicInteger<qint64> m_nextReconnectAtMs; // 0 表示未在等待重连
+    QAtomicInt m_connected;
+    
+    bool m_hasConnected;        // 是否曾经连接成功过
+    QDateTime m_reconnectedAt;  // 最近一次重连成功的时间，首次连接时无效
+    QAtomicInteger<quint64> m_receivedCount;
+    QAtomicInteger<quint64> m_deliveredCount;
+    QAtomicInteger<quint64> m_duplicateCount;
+    QAtomicInteger<quint64> m_recoveredCount;
+    QAtomicInteger<quint64> m_parseFailureCount;
+    QAtomicInteger<quint64> m_reconnectAttemptCount;
+    QAtomicInteger<quint64> m_overloadDropCount;
+    QAtomicInt m_inboundDepth;
+    QAtomicInt m_overloaded;
+    QAtomicInt m_syncing;
+    QAtomicInt m_lastSyncDurationMs;
+    QAtomicInt m_lastSyncMessages;
 };
 
 #endif // MQTTCLIENT_H
@@ -0,0 +1,214 @@
+#include "notificationmanager.h"
+#include "logger.h"
+#include <QApplication>
+#include <QScreen>
+
+namespace {
+const int ScreenMargin = 20;   // 与屏幕边缘的距离
+const int StackSpacing = 0;    // 通知之间的间距（窗口自带透明边距）
+}
+
+NotificationManager::NotificationManager(int maxVisible, NotificationWidget::Renderer renderer, QObject *parent)
+    : QObject(parent)
+    , m_maxVisible(0)
+    , m_renderer(renderer)
+    , m_evictedCount(0)
+{
+    setMaxVisible(maxVisible);
+}
+
+NotificationManager::~NotificationManager()
+{
+    qDeleteAll(m_pool);
+    m_pool.clear();
+    m_idle.clear();
+    m_visible.clear();
+}
+
+void NotificationManager::setMaxVisible(int count)
+{
+    count = qMax(1, count);
+    
+    // 缩小池时先关闭多出的通知
+    while (m_visible.size() > count) {
+        NotificationWidget *widget = m_visible.takeLast();
+        m_priorities.remove(widget);
+        widget->dismiss();
+        m_idle.append(widget);
+    }
+    while (m_pool.size() > count && !m_idle.isEmpty()) {
+        NotificationWidget *widget = m_idle.takeLast();
+        m_pool.removeOne(widget);
+        delete widget;
+    }
+    
+    // 扩大池时预先创建窗口，显示通知时不再构造新窗口
+    while (m_pool.size() < count) {
+        m_idle.append(createWidget());
+    }
+    
+    m_maxVisible = count;
+    layoutStack();
+}
+
+int NotificationManager::maxVisible() const
+{
+    return m_maxVisible;
+}
+
+void NotificationManager::setRenderer(NotificationWidget::Renderer renderer)
+{
+    if (m_renderer == renderer) {
+        return;
+    }
+    
+    closeAll();
+    qDeleteAll(m_pool);
+    m_pool.clear();
+    m_idle.clear();
+    
+    m_renderer = renderer;
+    while (m_pool.size() < m_maxVisible) {
+        m_idle.append(createWidget());
+    }
+    LOG_INFO_CAT(Logger::Ui, QString("通知渲染方式已切换为 %1")
+                 .arg(renderer == NotificationWidget::Painted ? "painted" : "stylesheet"));
+}
+
+NotificationWidget::Renderer NotificationManager::renderer() const
+{
+    return m_renderer;
+}
+
+NotificationWidget *NotificationManager::createWidget()
+{
+    NotificationWidget *widget = new NotificationWidget(m_renderer);
+    m_pool.append(widget);
+    
+    connect(widget, &NotificationWidget::notificationClosed, this, [this, widget]() {
+        releaseWidget(widget);
+    });
+    return widget;
+}
+
+void NotificationManager::showNotification(const QString &title, const QString &message, int duration,
+                                           DoorEvent::Priority priority)
+{
+    if (!QApplication::primaryScreen()) {
+        LOG_WARNING_CAT(Logger::Ui, "未找到可用屏幕，无法显示通知");
+        return;
+    }
+    
+    NotificationWidget *widget = acquireWidget();
+    m_visible.prepend(widget);
+    m_priorities.insert(widget, priority);
+    layoutStack();
+    widget->showNotification(title, message, duration);
+}
+
+void NotificationManager::closeAll()
+{
+    for (NotificationWidget *widget : m_visible) {
+        widget->dismiss();
+        m_idle.append(widget);
+    }
+    bool hadVisible = !m_visible.isEmpty();
+    m_visible.clear();
+    m_priorities.clear();
+    if (hadVisible) {
+        emit allNotificationsClosed();
+    }
+}
+
+void NotificationManager::prewarm()
+{
+    for (NotificationWidget *widget : m_idle) {
+        widget->prewarm();
+    }
+}
+
+NotificationWidget *NotificationManager::acquireWidget()
+{
+    if (!m_idle.isEmpty()) {
+        return m_idle.takeLast();
+    }
+    
+    // 池已用完：替换优先级最低的通知中最早显示的一条（m_visible 最新的在前，从后往前找）
+    int victim = m_visible.size() - 1;
+    for (int i = m_visible.size() - 2; i >= 0; --i) {
+        if (m_priorities.value(m_visible.at(i)) < m_priorities.value(m_visible.at(victim))) {
+            victim = i;
+        }
+    }
+    NotificationWidget *widget = m_visible.takeAt(victim);
+    DoorEvent::Priority priority = m_priorities.take(widget);
+    widget->dismiss();
+    ++m_evictedCount;
+    LOG_DEBUG_CAT(Logger::Ui, QString("通知数量已达上限 %1，替换一条 %2 优先级的通知")
+                  .arg(m_maxVisible)
+                  .arg(DoorEvent::priorityName(priority)));
+    return widget;
+}
+
+void NotificationManager::releaseWidget(NotificationWidget *widget)
+{
+    if (!m_visible.removeOne(widget)) {
+        return;
+    }
+    
+    m_priorities.remove(widget);
+    m_idle.append(widget);
+    layoutStack();
+    
+    // 先让调度器补上排队的通知，之后仍然没有通知时才算全部关闭
+    emit notificationReleased();
+    if (m_visible.isEmpty()) {
+        emit allNotificationsClosed();
+    }
+}
+
+void NotificationManager::layoutStack()
+{
+    QScreen *screen = QApplication::primaryScreen();
+    if (!screen) {
+        return;
+    }
+    
+    // 最新的通知在最下方，其余依次向上堆叠
+    QRect screenGeometry = screen->availableGeometry();
+    int y = screenGeometry.bottom() - ScreenMargin;
+    for (NotificationWidget *widget : m_visible) {
+        y -= widget->height();
+        widget->move(screenGeometry.right() - widget->width() - ScreenMargin, y);
+        y -= StackSpacing;
+    }
+}
+
+int NotificationManager::visibleCount() const
+{
+    return m_visible.size();
+}
+
+int NotificationManager::poolSize() const
+{
+    return m_pool.size();
+}
+
+quint64 NotificationManager::evictedCount() const
+{
+    return m_evictedCount;
+}
+
+bool NotificationManager::isFull() const
+{
+    return m_idle.isEmpty();
+}
+
+DoorEvent::Priority NotificationManager::lowestVisiblePriority() const
+{
+    DoorEvent::Priority lowest = DoorEvent::Critical;
+    for (NotificationWidget *widget : m_visible) {
+        lowest = qMin(lowest, m_priorities.value(widget));
+    }
+    return lowest;
+}
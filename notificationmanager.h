@@ -0,0 +1,60 @@
+#ifndef NOTIFICATIONMANAGER_H
+#define NOTIFICATIONMANAGER_H
+
+#include <QObject>
+#include <QList>
+#include <QHash>
+#include "notificationwidget.h"
+#include "doorevent.h"
+
+// 通知管理器：在屏幕右下角堆叠显示多条通知
+// 通知窗口来自预先创建的窗口池，数量固定，满时替换优先级最低的通知中最早的一条
+class NotificationManager : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit NotificationManager(int maxVisible = 3,
+                                 NotificationWidget::Renderer renderer = NotificationWidget::StyleSheet,
+                                 QObject *parent = nullptr);
+    ~NotificationManager();
+    
+    void setMaxVisible(int count);
+    int maxVisible() const;
+    // 切换渲染方式时关闭当前通知并重建窗口池
+    void setRenderer(NotificationWidget::Renderer renderer);
+    NotificationWidget::Renderer renderer() const;
+    
+    void showNotification(const QString &title, const QString &message, int duration,
+                          DoorEvent::Priority priority = DoorEvent::Normal);
+    void closeAll();
+    // 对池中的空闲窗口离屏绘制一次，见 NotificationWidget::prewarm()
+    void prewarm();
+    
+    int visibleCount() const;
+    int poolSize() const;
+    quint64 evictedCount() const;
+    // 窗口池已全部在显示，再显示通知需要替换 lowestVisiblePriority() 的一条
+    bool isFull() const;
+    DoorEvent::Priority lowestVisiblePriority() const;
+
+signals:
+    void notificationReleased();     // 一条通知关闭，池中有了空闲窗口
+    void allNotificationsClosed();
+
+private:
+    NotificationWidget *createWidget();
+    NotificationWidget *acquireWidget();
+    void releaseWidget(NotificationWidget *widget);
+    void layoutStack();
+    
+    int m_maxVisible;
+    NotificationWidget::Renderer m_renderer;
+    QList<NotificationWidget*> m_pool;     // 池中全部窗口
+    QList<NotificationWidget*> m_idle;     // 空闲窗口
+    QList<NotificationWidget*> m_visible;  // 正在显示的窗口，最新的在前
+    QHash<NotificationWidget*, DoorEvent::Priority> m_priorities;  // 正在显示的窗口 -> 优先级
+    quint64 m_evictedCount;
+};
+
+#endif // NOTIFICATIONMANAGER_H
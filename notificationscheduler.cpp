@@ -0,0 +1,160 @@
+#include "notificationscheduler.h"
+#include "notificationmanager.h"
+#include "soundbank.h"
+#include "latencymonitor.h"
+#include "logger.h"
+
+NotificationScheduler::NotificationScheduler(NotificationManager *notifications, SoundBank *soundBank, QObject *parent)
+    : QObject(parent)
+    , m_notifications(notifications)
+    , m_soundBank(soundBank)
+    , m_latencyMonitor(nullptr)
+    , m_capacity(20)
+    , m_queued(0)
+    , m_soundPriority(DoorEvent::Low)
+    , m_deferredCount(0)
+    , m_droppedCount(0)
+{
+    for (int i = 0; i < DoorEvent::PriorityCount; ++i) {
+        m_durations[i] = 3000;
+        m_soundLoops[i] = true;
+    }
+    
+    connect(m_notifications, &NotificationManager::notificationReleased, this, [this]() {
+        onNotificationReleased();
+    });
+}
+
+void NotificationScheduler::setQueueCapacity(int capacity)
+{
+    m_capacity = qMax(0, capacity);
+    
+    // 缩小上限时按丢弃规则裁掉多出的通知
+    for (int priority = DoorEvent::Low; m_queued > m_capacity && priority < DoorEvent::PriorityCount; ++priority) {
+        while (m_queued > m_capacity && !m_queues[priority].isEmpty()) {
+            m_queues[priority].dequeue();
+            --m_queued;
+            ++m_droppedCount;
+        }
+    }
+}
+
+void NotificationScheduler::setDuration(DoorEvent::Priority priority, int durationMs)
+{
+    m_durations[priority] = qMax(1, durationMs);
+}
+
+void NotificationScheduler::setSoundLoop(DoorEvent::Priority priority, bool loop)
+{
+    m_soundLoops[priority] = loop;
+}
+
+void NotificationScheduler::setLatencyMonitor(LatencyMonitor *monitor)
+{
+    m_latencyMonitor = monitor;
+}
+
+void NotificationScheduler::submit(const QString &title, const QString &message, const QString &eventType,
+                                   DoorEvent::Priority priority, const DoorEvent &source)
+{
+    Pending pending;
+    pending.title = title;
+    pending.message = message;
+    pending.eventType = eventType;
+    pending.source = source;
+    
+    // 有空闲窗口，或者屏幕上有不高于它的通知可以替换
+    if (!m_notifications->isFull() || priority >= m_notifications->lowestVisiblePriority()) {
+        present(pending, priority);
+        return;
+    }
+    
+    enqueue(pending, priority);
+}
+
+void NotificationScheduler::present(const Pending &pending, DoorEvent::Priority priority)
+{
+    // 正在播放的更高优先级提示音（例如循环的报警音）不被打断
+    if (!m_soundBank->isPlaying() || priority >= m_soundPriority) {
+        m_soundBank->play(pending.eventType, m_soundLoops[priority]);
+        m_soundPriority = priority;
+    }
+    
+    m_notifications->showNotification(pending.title, pending.message, m_durations[priority], priority);
+    if (m_latencyMonitor) {
+        m_latencyMonitor->recordEvent(pending.source);
+    }
+    
+    LOG_INFO_CAT(Logger::Ui, QString("显示通知 [%1]: %2 - %3")
+                 .arg(DoorEvent::priorityName(priority))
+                 .arg(pending.title)
+                 .arg(pending.message));
+}
+
+void NotificationScheduler::enqueue(const Pending &pending, DoorEvent::Priority priority)
+{
+    ++m_deferredCount;
+    
+    if (m_queued >= m_capacity) {
+        // 先丢弃优先级最低、最早进入队列的通知；新通知的优先级比队列中的都低时丢弃新通知
+        int lowest = DoorEvent::Low;
+        while (lowest < DoorEvent::PriorityCount && m_queues[lowest].isEmpty()) {
+            ++lowest;
+        }
+        ++m_droppedCount;
+        if (lowest >= DoorEvent::PriorityCount || priority < lowest) {
+            LOG_WARNING_CAT(Logger::Ui, QString("通知队列已满（%1），丢弃 %2 优先级的通知: %3")
+                            .arg(m_capacity)
+                            .arg(DoorEvent::priorityName(priority))
+                            .arg(pending.message));
+            return;
+        }
+        Pending dropped = m_queues[lowest].dequeue();
+        --m_queued;
+        LOG_WARNING_CAT(Logger::Ui, QString("通知队列已满（%1），丢弃 %2 优先级的通知: %3")
+                        .arg(m_capacity)
+                        .arg(DoorEvent::priorityName(DoorEvent::Priority(lowest)))
+                        .arg(dropped.message));
+    }
+    
+    m_queues[priority].enqueue(pending);
+    ++m_queued;
+    LOG_DEBUG_CAT(Logger::Ui, QString("屏幕上的通知优先级更高，%1 优先级的通知进入队列（%2 条排队）")
+                  .arg(DoorEvent::priorityName(priority))
+                  .arg(m_queued));
+}
+
+void NotificationScheduler::onNotificationReleased()
+{
+    // 有空闲窗口时从最高优先级开始出队
+    for (int priority = DoorEvent::Critical; priority >= DoorEvent::Low; --priority) {
+        while (!m_queues[priority].isEmpty() && !m_notifications->isFull()) {
+            Pending pending = m_queues[priority].dequeue();
+            --m_queued;
+            present(pending, DoorEvent::Priority(priority));
+        }
+    }
+}
+
+void NotificationScheduler::clear()
+{
+    for (int i = 0; i < DoorEvent::PriorityCount; ++i) {
+        m_queues[i].clear();
+    }
+    m_queued = 0;
+}
+
+int NotificationScheduler::queueDepth() const
+{
+    return m_queued;
+}
+
+quint64 NotificationScheduler::deferredCount() const
+{
+    return m_deferredCount;
+}
+
+quint64 NotificationScheduler::droppedCount() const
+{
+    return m_droppedCount;
+}
@@ -0,0 +1,67 @@
+#ifndef NOTIFICATIONSCHEDULER_H
+#define NOTIFICATIONSCHEDULER_H
+
+#include <QObject>
+#include <QQueue>
+#include "doorevent.h"
+
+class NotificationManager;
+class SoundBank;
+class LatencyMonitor;
+
+// 通知调度：位于通知窗口和提示音之前，按优先级决定立即显示、替换还是排队
+// 屏幕已满时，新通知不低于屏幕上最低的优先级就替换其中最早的一条，否则进入有界队列；
+// 队列满时先丢弃优先级最低、最早进入队列的通知。有窗口空出后按优先级从高到低出队
+class NotificationScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    NotificationScheduler(NotificationManager *notifications, SoundBank *soundBank, QObject *parent = nullptr);
+    
+    // 排队上限，0 表示不排队（无法显示的通知直接丢弃）
+    void setQueueCapacity(int capacity);
+    void setDuration(DoorEvent::Priority priority, int durationMs);
+    void setSoundLoop(DoorEvent::Priority priority, bool loop);
+    // 通知真正显示时记录对应事件的延迟，排队中或被丢弃的通知不计入
+    void setLatencyMonitor(LatencyMonitor *monitor);
+    
+    // source 携带事件各阶段的时间，汇总通知等没有对应事件时传默认值
+    void submit(const QString &title, const QString &message, const QString &eventType,
+                DoorEvent::Priority priority, const DoorEvent &source = DoorEvent());
+    // 清空队列，不影响已经显示的通知
+    void clear();
+    
+    int queueDepth() const;
+    quint64 deferredCount() const;  // 因屏幕已满进入队列的通知数
+    quint64 droppedCount() const;   // 队列满时丢弃的通知数
+
+private:
+    struct Pending
+    {
+        QString title;
+        QString message;
+        QString eventType;
+        DoorEvent source;
+    };
+    
+    void present(const Pending &pending, DoorEvent::Priority priority);
+    void enqueue(const Pending &pending, DoorEvent::Priority priority);
+    void onNotificationReleased();
+    
+    NotificationManager *m_notifications;
+    SoundBank *m_soundBank;
+    LatencyMonitor *m_latencyMonitor;
+    int m_capacity;
+    int m_durations[DoorEvent::PriorityCount];
+    bool m_soundLoops[DoorEvent::PriorityCount];
+    
+    QQueue<Pending> m_queues[DoorEvent::PriorityCount];  // 每个优先级一个队列，同级先进先出
+    int m_queued;
+    DoorEvent::Priority m_soundPriority;  // 当前提示音对应的优先级，只被不低于它的通知打断
+    
+    quint64 m_deferredCount;
+    quint64 m_droppedCount;
+};
+
+#endif // NOTIFICATIONSCHEDULER_H
@@ -2,27 +2,53 @@
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QGraphicsOpacityEffect>
+#include <QPainter>
+#include <QMouseEvent>
 
-NotificationWidget::NotificationWidget(QWidget *parent)
+namespace {
+// Painted 模式的布局与样式表版本保持一致
+const int WindowMargin = 15;    // 窗口透明边距
+const int CardPadding = 20;     // 卡片内边距
+const int CardRadius = 12;
+const int BorderWidth = 3;
+const int TitleRowHeight = 30;  // 标题行高度（与关闭按钮等高）
+const int RowSpacing = 8;
+const QColor CardColor(0x2E, 0x34, 0x40);
+const QColor BorderColor(0x88, 0xC0, 0xD0);
+const QColor TitleColor(0x88, 0xC0, 0xD0);
+const QColor MessageColor(0xEC, 0xEF, 0xF4);
+const QColor CloseColor(0xD8, 0xDE, 0xE9);
+const QColor CloseHoverColor(0xBF, 0x61, 0x6A);
+const QColor ClosePressedColor(0xA5, 0x46, 0x50);
+}
+
+NotificationWidget::NotificationWidget(Renderer renderer, QWidget *parent)
     : QWidget(parent)
+    , m_renderer(renderer)
     , titleLabel(nullptr)
     , messageLabel(nullptr)
     , closeButton(nullptr)
     , closeTimer(new QTimer(this))
     , fadeOutAnimation(nullptr)
+    , m_closeHovered(false)
+    , m_closePressed(false)
 {
-    setupUI();
+    if (m_renderer == Painted) {
+        setupPainted();
+    } else {
+        setupUI();
+        
+        // 连接关闭按钮
+        connect(closeButton, &QPushButton::clicked, this, [this]() {
+            onCloseButtonClicked();
+        });
+    }
     
     // 使用 lambda 确保连接安全
     connect(closeTimer, &QTimer::timeout, this, [this]() {
         hideNotification();
     });
     closeTimer->setSingleShot(true);
-    
-    // 连接关闭按钮
-    connect(closeButton, &QPushButton::clicked, this, [this]() {
-        onCloseButtonClicked();
-    });
 }
 
 NotificationWidget::~NotificationWidget()
@@ -125,10 +151,197 @@ void NotificationWidget::setupUI()
     mainLayout->addWidget(container);
 }
 
+void NotificationWidget::setupPainted()
+{
+    setWindowFlags(Qt::FramelessWindowHint | Qt::WindowStaysOnTopHint | Qt::Tool);
+    setAttribute(Qt::WA_TranslucentBackground);
+    setAttribute(Qt::WA_ShowWithoutActivating);
+    setMouseTracking(true);
+    
+    setFixedSize(450, 150);
+    
+    m_titleFont = font();
+    m_titleFont.setPixelSize(20);
+    m_titleFont.setBold(true);
+    m_messageFont = font();
+    m_messageFont.setPixelSize(16);
+    m_closeFont = font();
+    m_closeFont.setPixelSize(24);
+    m_closeFont.setBold(true);
+    
+    QRect content = rect().adjusted(WindowMargin + CardPadding, WindowMargin + CardPadding,
+                                    -(WindowMargin + CardPadding), -(WindowMargin + CardPadding));
+    m_closeRect = QRect(content.right() - TitleRowHeight + 1, content.top(), TitleRowHeight, TitleRowHeight);
+    m_messageRect = QRect(content.left(), content.top() + TitleRowHeight + RowSpacing,
+                          content.width(), content.height() - TitleRowHeight - RowSpacing);
+    
+    // 纯文本，服务端消息中的尖括号不会被当作富文本
+    m_titleText.setTextFormat(Qt::PlainText);
+    m_messageText.setTextFormat(Qt::PlainText);
+    m_messageText.setTextWidth(m_messageRect.width());
+    m_closeText.setTextFormat(Qt::PlainText);
+    m_closeText.setText(QStringLiteral("×"));
+    m_closeText.prepare(QTransform(), m_closeFont);
+}
+
+void NotificationWidget::setTexts(const QString &title, const QString &message)
+{
+    if (m_renderer == StyleSheet) {
+        titleLabel->setText(title);
+        messageLabel->setText(message);
+        return;
+    }
+    
+    // 只有文字变化时才重新排版，相同内容的通知直接复用上次的排版结果
+    bool changed = false;
+    if (m_titleText.text() != title) {
+        m_titleText.setText(title);
+        m_titleText.prepare(QTransform(), m_titleFont);
+        changed = true;
+    }
+    if (m_messageText.text() != message) {
+        m_messageText.setText(message);
+        m_messageText.prepare(QTransform(), m_messageFont);
+        changed = true;
+    }
+    if (changed) {
+        update();
+    }
+}
+
+void NotificationWidget::updateBackground()
+{
+    qreal ratio = devicePixelRatioF();
+    QSize pixelSize = size() * ratio;
+    if (!m_background.isNull() && m_background.size() == pixelSize) {
+        return;
+    }
+    
+    m_background = QPixmap(pixelSize);
+    m_background.setDevicePixelRatio(ratio);
+    m_background.fill(Qt::transparent);
+    
+    QPainter painter(&m_background);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(QPen(BorderColor, BorderWidth));
+    painter.setBrush(CardColor);
+    qreal inset = WindowMargin + BorderWidth / 2.0;
+    painter.drawRoundedRect(QRectF(rect()).adjusted(inset, inset, -inset, -inset), CardRadius, CardRadius);
+}
+
+void NotificationWidget::setCloseHovered(bool hovered)
+{
+    if (m_closeHovered == hovered) {
+        return;
+    }
+    m_closeHovered = hovered;
+    if (!hovered) {
+        m_closePressed = false;
+    }
+    setCursor(hovered ? Qt::PointingHandCursor : Qt::ArrowCursor);
+    update(m_closeRect);
+}
+
+void NotificationWidget::paintEvent(QPaintEvent *event)
+{
+    if (m_renderer == StyleSheet) {
+        QWidget::paintEvent(event);
+        return;
+    }
+    
+    updateBackground();
+    
+    QPainter painter(this);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    painter.drawPixmap(0, 0, m_background);
+    painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+    
+    // 标题在标题行内垂直居中，宽度不超过关闭按钮左侧
+    QRect titleRect(m_messageRect.left(), m_closeRect.top(),
+                    m_closeRect.left() - m_messageRect.left(), TitleRowHeight);
+    painter.save();
+    painter.setClipRect(titleRect);
+    painter.setFont(m_titleFont);
+    painter.setPen(TitleColor);
+    painter.drawStaticText(titleRect.left(),
+                           titleRect.top() + (TitleRowHeight - qRound(m_titleText.size().height())) / 2,
+                           m_titleText);
+    painter.restore();
+    
+    painter.save();
+    painter.setClipRect(m_messageRect);
+    painter.setFont(m_messageFont);
+    painter.setPen(MessageColor);
+    painter.drawStaticText(m_messageRect.topLeft(), m_messageText);
+    painter.restore();
+    
+    if (m_closeHovered) {
+        painter.setRenderHint(QPainter::Antialiasing);
+        painter.setPen(Qt::NoPen);
+        painter.setBrush(m_closePressed ? ClosePressedColor : CloseHoverColor);
+        painter.drawEllipse(m_closeRect);
+    }
+    painter.setFont(m_closeFont);
+    painter.setPen(m_closeHovered ? QColor(Qt::white) : CloseColor);
+    QSizeF closeSize = m_closeText.size();
+    painter.drawStaticText(QPointF(m_closeRect.left() + (m_closeRect.width() - closeSize.width()) / 2,
+                                   m_closeRect.top() + (m_closeRect.height() - closeSize.height()) / 2),
+                           m_closeText);
+}
+
+void NotificationWidget::mouseMoveEvent(QMouseEvent *event)
+{
+    if (m_renderer == Painted) {
+        setCloseHovered(m_closeRect.contains(event->pos()));
+    }
+    QWidget::mouseMoveEvent(event);
+}
+
+void NotificationWidget::mousePressEvent(QMouseEvent *event)
+{
+    if (m_renderer == Painted && event->button() == Qt::LeftButton && m_closeRect.contains(event->pos())) {
+        m_closePressed = true;
+        update(m_closeRect);
+        return;
+    }
+    QWidget::mousePressEvent(event);
+}
+
+void NotificationWidget::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (m_renderer == Painted && m_closePressed && event->button() == Qt::LeftButton) {
+        m_closePressed = false;
+        update(m_closeRect);
+        if (m_closeRect.contains(event->pos())) {
+            onCloseButtonClicked();
+        }
+        return;
+    }
+    QWidget::mouseReleaseEvent(event);
+}
+
+void NotificationWidget::leaveEvent(QEvent *event)
+{
+    if (m_renderer == Painted) {
+        setCloseHovered(false);
+    }
+    QWidget::leaveEvent(event);
+}
+
+NotificationWidget::Renderer NotificationWidget::renderer() const
+{
+    return m_renderer;
+}
+
+NotificationWidget::Renderer NotificationWidget::rendererFromString(const QString &name)
+{
+    return name.trimmed().toLower() == "painted" ? Painted : StyleSheet;
+}
+
 void NotificationWidget::showNotification(const QString &title, const QString &message, int duration)
 {
-    // 如果有正在进行的淡出动画，停止它
-    if (fadeOutAnimation && fadeOutAnimation->state() == QAbstractAnimation::Running) {
+    // 如果有淡出动画（正在进行或刚结束），停止并丢弃它，避免复用时被隐藏
+    if (fadeOutAnimation) {
         fadeOutAnimation->stop();
         delete fadeOutAnimation;
         fadeOutAnimation = nullptr;
@@ -139,8 +352,7 @@ void NotificationWidget::showNotification(const QString &title, const QString &m
         closeTimer->stop();
     }
     
-    titleLabel->setText(title);
-    messageLabel->setText(message);
+    setTexts(title, message);
     
     // 重置透明度
     setWindowOpacity(1.0);
@@ -170,8 +382,10 @@ void NotificationWidget::hideNotification()
     fadeOutAnimation->setEndValue(0.0);
     
     // 使用 Qt::QueuedConnection 确保安全
-    connect(fadeOutAnimation, &QPropertyAnimation::finished, this, [this]() {
-        if (this) {  // 安全检查
+    QPropertyAnimation *animation = fadeOutAnimation;
+    connect(fadeOutAnimation, &QPropertyAnimation::finished, this, [this, animation]() {
+        // 窗口在淡出结束前已被重新显示时，忽略这次结束通知
+        if (fadeOutAnimation == animation) {
             hide();
             // 发送关闭信号
             emit notificationClosed();
@@ -186,6 +400,32 @@ void NotificationWidget::hideNotification()
     fadeOutAnimation->start();
 }
 
+void NotificationWidget::dismiss()
+{
+    if (closeTimer->isActive()) {
+        closeTimer->stop();
+    }
+    
+    if (fadeOutAnimation) {
+        fadeOutAnimation->stop();
+        delete fadeOutAnimation;
+        fadeOutAnimation = nullptr;
+    }
+    
+    hide();
+}
+
+void NotificationWidget::prewarm()
+{
+    // 样式表在第一次 polish 时解析，grab() 在离屏缓冲中完成布局和绘制；
+    // Painted 模式下同时生成背景缓存
+    setTexts(" ", " ");
+    ensurePolished();
+    grab();
+    // 提前创建原生窗口，第一次 show() 时只需映射到屏幕
+    winId();
+}
+
 void NotificationWidget::onCloseButtonClicked()
 {
     // 停止自动关闭定时器
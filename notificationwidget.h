@@ -6,32 +6,71 @@
 #include <QTimer>
 #include <QPropertyAnimation>
 #include <QPushButton>
+#include <QPixmap>
+#include <QStaticText>
 
 class NotificationWidget : public QWidget
 {
     Q_OBJECT
 
 public:
-    explicit NotificationWidget(QWidget *parent = nullptr);
+    // 渲染方式：StyleSheet 使用样式表和子控件；Painted 在 paintEvent 中绘制，
+    // 背景缓存为位图，文字使用 QStaticText，只在内容变化时重新排版
+    enum Renderer {
+        StyleSheet = 0,
+        Painted
+    };
+    
+    explicit NotificationWidget(Renderer renderer = StyleSheet, QWidget *parent = nullptr);
     ~NotificationWidget();
 
     void showNotification(const QString &title, const QString &message, int duration = 3000);
+    void dismiss();  // 立即隐藏，不播放淡出动画，也不发送关闭信号（窗口被复用时调用）
+    void prewarm();  // 不显示窗口，提前完成样式解析、布局和一次离屏绘制
+
+    Renderer renderer() const;
+    static Renderer rendererFromString(const QString &name);
 
 signals:
     void notificationClosed();  // 通知窗口关闭信号（自动或手动）
 
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+    void leaveEvent(QEvent *event) override;
+
 private slots:
     void hideNotification();
     void onCloseButtonClicked();
 
 private:
     void setupUI();
+    void setupPainted();
+    void setTexts(const QString &title, const QString &message);
+    void updateBackground();
+    void setCloseHovered(bool hovered);
 
+    Renderer m_renderer;
     QLabel *titleLabel;
     QLabel *messageLabel;
     QPushButton *closeButton;
     QTimer *closeTimer;
     QPropertyAnimation *fadeOutAnimation;
+    
+    // Painted 模式
+    QPixmap m_background;      // 卡片背景，窗口大小或设备像素比变化时重新生成
+    QStaticText m_titleText;
+    QStaticText m_messageText;
+    QStaticText m_closeText;
+    QFont m_titleFont;
+    QFont m_messageFont;
+    QFont m_closeFont;
+    QRect m_closeRect;
+    QRect m_messageRect;
+    bool m_closeHovered;
+    bool m_closePressed;
 };
 
 #endif // NOTIFICATIONWIDGET_H
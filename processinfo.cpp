@@ -0,0 +1,36 @@
+#include "processinfo.h"
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#include <psapi.h>
+#elif defined(Q_OS_LINUX)
+#include <QFile>
+#include <QByteArray>
+#include <QList>
+#endif
+
+qint64 ProcessInfo::residentMemoryBytes()
+{
+#ifdef Q_OS_WIN
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return qint64(counters.WorkingSetSize);
+    }
+    return -1;
+#elif defined(Q_OS_LINUX)
+    // /proc/self/status 中的 VmRSS 以 kB 为单位；proc 文件大小为 0，只能用 readAll 读取
+    QFile status("/proc/self/status");
+    if (!status.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+    const QList<QByteArray> lines = status.readAll().split('\n');
+    for (const QByteArray &line : lines) {
+        if (line.startsWith("VmRSS:")) {
+            return line.mid(6).simplified().split(' ').value(0).toLongLong() * 1024;
+        }
+    }
+    return -1;
+#else
+    return -1;
+#endif
+}
@@ -0,0 +1,14 @@
+#ifndef PROCESSINFO_H
+#define PROCESSINFO_H
+
+#include <QtGlobal>
+
+// 当前进程的资源占用，用于启动耗时/内存对比和监控输出
+class ProcessInfo
+{
+public:
+    // 常驻内存（字节），无法获取时返回 -1
+    static qint64 residentMemoryBytes();
+};
+
+#endif // PROCESSINFO_H
@@ -0,0 +1,50 @@
+#include "reconnectpolicy.h"
+#include <QRandomGenerator>
+#include <QtGlobal>
+
+ReconnectPolicy *ReconnectPolicy::create(const QString &name, int intervalMs, int minMs, int maxMs)
+{
+    if (name.compare("fixed", Qt::CaseInsensitive) == 0) {
+        return new FixedReconnectPolicy(intervalMs);
+    }
+    return new ExponentialReconnectPolicy(minMs, maxMs);
+}
+
+FixedReconnectPolicy::FixedReconnectPolicy(int intervalMs)
+    : m_interval(qMax(0, intervalMs))
+{
+}
+
+int FixedReconnectPolicy::nextDelay(int attempt)
+{
+    Q_UNUSED(attempt);
+    return m_interval;
+}
+
+QString FixedReconnectPolicy::name() const
+{
+    return "fixed";
+}
+
+ExponentialReconnectPolicy::ExponentialReconnectPolicy(int minMs, int maxMs)
+    : m_min(qMax(0, minMs))
+    , m_max(qMax(qMax(0, minMs), maxMs))
+{
+}
+
+int ExponentialReconnectPolicy::nextDelay(int attempt)
+{
+    // 完全抖动：第一次重连的上限就是 min 的两倍，避免同时断线的客户端同步重连
+    // 限制移位位数，避免溢出
+    int shift = qBound(1, attempt, 30);
+    qint64 ceiling = qMin<qint64>(m_max, qint64(qMax(1, m_min)) << shift);
+    if (ceiling <= m_min) {
+        return m_min;
+    }
+    return QRandomGenerator::global()->bounded(m_min, int(ceiling) + 1);
+}
+
+QString ExponentialReconnectPolicy::name() const
+{
+    return "exponential";
+}
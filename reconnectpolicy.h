@@ -0,0 +1,49 @@
+#ifndef RECONNECTPOLICY_H
+#define RECONNECTPOLICY_H
+
+#include <QString>
+
+// 重连策略：根据已失败的次数计算下一次重连前的等待时间
+class ReconnectPolicy
+{
+public:
+    virtual ~ReconnectPolicy() {}
+    
+    // attempt 从 1 开始，返回等待的毫秒数
+    virtual int nextDelay(int attempt) = 0;
+    virtual QString name() const = 0;
+    
+    // 按名称创建策略：fixed 使用固定间隔 intervalMs，exponential 在 [minMs, maxMs] 内退避
+    // 无法识别的名称按 exponential 处理
+    static ReconnectPolicy *create(const QString &name, int intervalMs, int minMs, int maxMs);
+};
+
+// 固定间隔重连
+class FixedReconnectPolicy : public ReconnectPolicy
+{
+public:
+    explicit FixedReconnectPolicy(int intervalMs);
+    
+    int nextDelay(int attempt) override;
+    QString name() const override;
+
+private:
+    int m_interval;
+};
+
+// 指数退避 + 全抖动：上限按 min * 2^attempt 增长到 max，实际等待在 [min, 上限] 内随机，
+// 第一次重连也带随机量，避免服务端重启后所有客户端同时重连
+class ExponentialReconnectPolicy : public ReconnectPolicy
+{
+public:
+    ExponentialReconnectPolicy(int minMs, int maxMs);
+    
+    int nextDelay(int attempt) override;
+    QString name() const override;
+
+private:
+    int m_min;
+    int m_max;
+};
+
+#endif // RECONNECTPOLICY_H
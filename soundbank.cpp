@@ -0,0 +1,210 @@
+#include "soundbank.h"
+#include "logger.h"
+#include <QFileInfo>
+#include <QUrl>
+
+SoundBank::SoundBank(QObject *parent)
+    : QObject(parent)
+    , m_defaultEffect(nullptr)
+    , m_currentEffect(nullptr)
+    , m_watcher(new QFileSystemWatcher(this))
+    , m_volume(1.0)
+    , m_loop(true)
+    , m_latencyPending(false)
+    , m_lastLatencyMs(0)
+    , m_maxLatencyMs(0)
+    , m_totalLatencyMs(0)
+    , m_latencySamples(0)
+{
+    connect(m_watcher, &QFileSystemWatcher::fileChanged, this, [this](const QString &path) {
+        onFileChanged(path);
+    });
+}
+
+SoundBank::~SoundBank()
+{
+    clear();
+}
+
+void SoundBank::load(const QString &defaultPath, const QHash<QString, QString> &eventPaths)
+{
+    clear();
+    
+    if (!defaultPath.isEmpty()) {
+        m_defaultEffect = loadEffect(defaultPath);
+    }
+    
+    for (QHash<QString, QString>::const_iterator it = eventPaths.constBegin(); it != eventPaths.constEnd(); ++it) {
+        if (it.value().isEmpty()) {
+            continue;
+        }
+        QSoundEffect *effect = loadEffect(it.value());
+        if (effect) {
+            m_effectsByEvent.insert(it.key(), effect);
+        }
+    }
+    
+    LOG_INFO_CAT(Logger::Ui, QString("提示音库已加载 %1 个音频文件，%2 个事件类型单独配置")
+                 .arg(m_effectsByPath.size())
+                 .arg(m_effectsByEvent.size()));
+}
+
+QSoundEffect *SoundBank::loadEffect(const QString &path)
+{
+    QFileInfo fileInfo(path);
+    if (!fileInfo.exists()) {
+        LOG_WARNING_CAT(Logger::Ui, QString("音频文件不存在: %1").arg(path));
+        return nullptr;
+    }
+    
+    QString absolutePath = fileInfo.absoluteFilePath();
+    QSoundEffect *effect = m_effectsByPath.value(absolutePath, nullptr);
+    if (effect) {
+        return effect;
+    }
+    
+    // 设置音频源后 QSoundEffect 会在后台解码，播放时无需再次加载
+    effect = new QSoundEffect(this);
+    applySettings(effect);
+    effect->setSource(QUrl::fromLocalFile(absolutePath));
+    
+    connect(effect, &QSoundEffect::playingChanged, this, [this, effect]() {
+        if (m_latencyPending && effect == m_currentEffect && effect->isPlaying()) {
+            m_latencyPending = false;
+            m_lastLatencyMs = int(m_latencyTimer.elapsed());
+            m_maxLatencyMs = qMax(m_maxLatencyMs, m_lastLatencyMs);
+            m_totalLatencyMs += m_lastLatencyMs;
+            ++m_latencySamples;
+            LOG_DEBUG_CAT(Logger::Ui, QString("提示音播放延迟: %1 ms").arg(m_lastLatencyMs));
+            emit playbackStarted(m_latencyTimer.nsecsElapsed() / 1000);
+        }
+    });
+    connect(effect, &QSoundEffect::statusChanged, this, [effect, absolutePath]() {
+        if (effect->status() == QSoundEffect::Error) {
+            LOG_WARNING_CAT(Logger::Ui, QString("音频文件加载失败: %1").arg(absolutePath));
+        }
+    });
+    
+    m_effectsByPath.insert(absolutePath, effect);
+    m_watcher->addPath(absolutePath);
+    return effect;
+}
+
+void SoundBank::applySettings(QSoundEffect *effect)
+{
+    effect->setVolume(m_volume);
+    effect->setLoopCount(m_loop ? QSoundEffect::Infinite : 1);
+}
+
+void SoundBank::setVolume(qreal volume)
+{
+    // 确保音量在有效范围内
+    m_volume = qBound(qreal(0.0), volume, qreal(1.0));
+    for (QSoundEffect *effect : m_effectsByPath) {
+        applySettings(effect);
+    }
+}
+
+void SoundBank::setLoopMode(const QString &loopMode)
+{
+    m_loop = (loopMode == "loop");
+    for (QSoundEffect *effect : m_effectsByPath) {
+        applySettings(effect);
+    }
+}
+
+void SoundBank::play(const QString &eventType)
+{
+    play(eventType, m_loop);
+}
+
+void SoundBank::play(const QString &eventType, bool loop)
+{
+    QSoundEffect *effect = m_effectsByEvent.value(eventType, m_defaultEffect);
+    if (!effect) {
+        return;
+    }
+    
+    // 停止之前的播放
+    if (m_currentEffect && m_currentEffect->isPlaying()) {
+        m_currentEffect->stop();
+    }
+    
+    if (effect->status() != QSoundEffect::Ready && effect->status() != QSoundEffect::Loading) {
+        LOG_WARNING_CAT(Logger::Ui, QString("提示音不可用: %1").arg(effect->source().toLocalFile()));
+        return;
+    }
+    
+    m_currentEffect = effect;
+    m_latencyPending = true;
+    m_latencyTimer.start();
+    effect->setLoopCount(loop ? QSoundEffect::Infinite : 1);
+    effect->play();
+    
+    LOG_DEBUG_CAT(Logger::Ui, QString("播放通知音频（%1）: %2")
+                  .arg(loop ? "循环模式" : "单次模式")
+                  .arg(effect->source().toLocalFile()));
+}
+
+void SoundBank::stop()
+{
+    if (m_currentEffect && m_currentEffect->isPlaying()) {
+        m_currentEffect->stop();
+    }
+    m_latencyPending = false;
+}
+
+bool SoundBank::isPlaying() const
+{
+    return m_currentEffect && m_currentEffect->isPlaying();
+}
+
+void SoundBank::onFileChanged(const QString &path)
+{
+    QSoundEffect *effect = m_effectsByPath.value(path, nullptr);
+    if (!effect) {
+        return;
+    }
+    
+    // 部分编辑器以"删除后重建"的方式保存文件，监视会被移除，需要重新添加
+    if (QFileInfo::exists(path) && !m_watcher->files().contains(path)) {
+        m_watcher->addPath(path);
+    }
+    
+    if (effect == m_currentEffect) {
+        stop();
+    }
+    
+    // 相同 URL 不会触发重新加载，先清空再设置
+    effect->setSource(QUrl());
+    effect->setSource(QUrl::fromLocalFile(path));
+    LOG_INFO_CAT(Logger::Ui, QString("音频文件已变化，重新加载: %1").arg(path));
+}
+
+void SoundBank::clear()
+{
+    stop();
+    if (!m_effectsByPath.isEmpty()) {
+        m_watcher->removePaths(m_effectsByPath.keys());
+    }
+    qDeleteAll(m_effectsByPath);
+    m_effectsByPath.clear();
+    m_effectsByEvent.clear();
+    m_defaultEffect = nullptr;
+    m_currentEffect = nullptr;
+}
+
+int SoundBank::lastLatencyMs() const
+{
+    return m_lastLatencyMs;
+}
+
+int SoundBank::maxLatencyMs() const
+{
+    return m_maxLatencyMs;
+}
+
+double SoundBank::averageLatencyMs() const
+{
+    return m_latencySamples > 0 ? double(m_totalLatencyMs) / m_latencySamples : 0.0;
+}
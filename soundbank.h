@@ -0,0 +1,63 @@
+#ifndef SOUNDBANK_H
+#define SOUNDBANK_H
+
+#include <QObject>
+#include <QHash>
+#include <QSoundEffect>
+#include <QFileSystemWatcher>
+#include <QElapsedTimer>
+
+// 提示音库：启动时按事件类型预加载并解码音频，播放时直接 play()
+// 音频文件只在磁盘上发生变化时重新加载
+class SoundBank : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SoundBank(QObject *parent = nullptr);
+    ~SoundBank();
+    
+    // defaultPath 用于未单独配置的事件类型，eventPaths 为 事件类型 -> 音频文件
+    void load(const QString &defaultPath, const QHash<QString, QString> &eventPaths);
+    void setVolume(qreal volume);
+    void setLoopMode(const QString &loopMode);
+    
+    void play(const QString &eventType);
+    // 本次播放使用指定的模式，不改变 setLoopMode() 的默认值
+    void play(const QString &eventType, bool loop);
+    void stop();
+    bool isPlaying() const;
+    
+    // 从调用 play() 到音频实际开始播放的延迟统计
+    int lastLatencyMs() const;
+    int maxLatencyMs() const;
+    double averageLatencyMs() const;
+
+signals:
+    void playbackStarted(qint64 latencyUs);  // 音频实际开始播放，参数为 play() 之后的延迟
+
+private slots:
+    void onFileChanged(const QString &path);
+
+private:
+    QSoundEffect *loadEffect(const QString &path);
+    void applySettings(QSoundEffect *effect);
+    void clear();
+    
+    QHash<QString, QSoundEffect*> m_effectsByPath;   // 绝对路径 -> 音效，同一文件只加载一次
+    QHash<QString, QSoundEffect*> m_effectsByEvent;  // 事件类型 -> 音效
+    QSoundEffect *m_defaultEffect;
+    QSoundEffect *m_currentEffect;
+    QFileSystemWatcher *m_watcher;
+    qreal m_volume;
+    bool m_loop;
+    
+    QElapsedTimer m_latencyTimer;
+    bool m_latencyPending;
+    int m_lastLatencyMs;
+    int m_maxLatencyMs;
+    qint64 m_totalLatencyMs;
+    int m_latencySamples;
+};
+
+#endif // SOUNDBANK_H
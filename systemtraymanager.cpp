@@ -1,11 +1,17 @@
 #include "systemtraymanager.h"
 #include "clientmanager.h"
 #include "logger.h"
+#include "configmanager.h"
 #include <QApplication>
 #include <QMessageBox>
 #include <QSettings>
 #include <QDir>
 #include <QStyle>
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QDateTimeEdit>
+#include <QFormLayout>
+#include <QTimer>
 
 #ifdef Q_OS_WIN
 #include <windows.h>
@@ -16,12 +22,32 @@ SystemTrayManager::SystemTrayManager(ClientManager *manager, QObject *parent)
     , m_clientManager(manager)
     , m_trayIcon(nullptr)
     , m_trayMenu(nullptr)
+    , m_statusAction(nullptr)
+    , m_recentEventsAction(nullptr)
+    , m_eventsBetweenAction(nullptr)
+    , m_autoStartAction(nullptr)
+    , m_exitAction(nullptr)
+    , m_toolTipTimer(nullptr)
 {
     createActions();
     createMenu();
     createTrayIcon();
     
-    LOG_INFO("系统托盘管理器已初始化");
+    // 门状态摘要只在计数变化时重新生成，托盘提示最多每 500 ms 刷新一次
+    m_toolTipTimer = new QTimer(this);
+    m_toolTipTimer->setSingleShot(true);
+    m_toolTipTimer->setInterval(500);
+    connect(m_toolTipTimer, &QTimer::timeout, this, [this]() {
+        updateToolTip();
+    });
+    connect(m_clientManager, &ClientManager::doorSummaryChanged, this, [this]() {
+        if (!m_toolTipTimer->isActive()) {
+            m_toolTipTimer->start();
+        }
+    });
+    updateToolTip();
+    
+    LOG_INFO_CAT(Logger::Ui, "系统托盘管理器已初始化");
 }
 
 SystemTrayManager::~SystemTrayManager()
@@ -42,6 +68,16 @@ void SystemTrayManager::createActions()
         onShowStatus();
     });
     
+    m_recentEventsAction = new QAction(tr("最近事件"), this);
+    connect(m_recentEventsAction, &QAction::triggered, this, [this]() {
+        onShowRecentEvents();
+    });
+    
+    m_eventsBetweenAction = new QAction(tr("按时间查询事件..."), this);
+    connect(m_eventsBetweenAction, &QAction::triggered, this, [this]() {
+        onShowEventsBetween();
+    });
+    
     m_autoStartAction = new QAction(tr("开机自启动"), this);
     m_autoStartAction->setCheckable(true);
     connect(m_autoStartAction, &QAction::triggered, this, [this]() {
@@ -60,6 +96,8 @@ void SystemTrayManager::createMenu()
 {
     m_trayMenu = new QMenu();
     m_trayMenu->addAction(m_statusAction);
+    m_trayMenu->addAction(m_recentEventsAction);
+    m_trayMenu->addAction(m_eventsBetweenAction);
     m_trayMenu->addSeparator();
     m_trayMenu->addAction(m_autoStartAction);
     m_trayMenu->addSeparator();
@@ -75,9 +113,9 @@ void SystemTrayManager::createTrayIcon()
     if (icon.isNull()) {
         // 如果自定义图标不存在，使用系统默认图标
         icon = QApplication::style()->standardIcon(QStyle::SP_ComputerIcon);
-        LOG_WARNING("未找到自定义图标，使用系统默认图标");
+        LOG_WARNING_CAT(Logger::Ui, "未找到自定义图标，使用系统默认图标");
     } else {
-        LOG_INFO("已加载自定义托盘图标");
+        LOG_INFO_CAT(Logger::Ui, "已加载自定义托盘图标");
     }
     m_trayIcon->setIcon(icon);
     
@@ -115,13 +153,70 @@ void SystemTrayManager::onTrayIconActivated(QSystemTrayIcon::ActivationReason re
     }
 }
 
+void SystemTrayManager::updateToolTip()
+{
+    const DoorStateTable &doors = m_clientManager->doorStates();
+    if (doors.doorCount() == 0) {
+        m_trayIcon->setToolTip(tr("门禁状态客户端 - 运行中"));
+        return;
+    }
+    m_trayIcon->setToolTip(tr("门禁状态客户端 - 运行中\n%1").arg(doors.summary()));
+}
+
 void SystemTrayManager::onShowStatus()
 {
     QString statusText = tr("门禁状态客户端\n\n");
     statusText += tr("状态: 运行中\n");
+    
+    MqttClient *mqtt = m_clientManager->mqtt();
+    if (mqtt->isConnected()) {
+        statusText += tr("MQTT: 已连接\n");
+    } else if (mqtt->nextReconnectTime().isValid()) {
+        statusText += tr("MQTT: 等待第 %1 次重连，预计 %2\n")
+                .arg(mqtt->currentReconnectAttempt())
+                .arg(mqtt->nextReconnectTime().toString("HH:mm:ss"));
+    } else {
+        statusText += tr("MQTT: 未连接\n");
+    }
+    statusText += tr("重连策略: %1\n").arg(ConfigManager::instance()->snapshot()->mqttReconnectPolicy);
+    statusText += tr("消息: 已处理 %1，重复丢弃 %2，重连补收 %3\n")
+            .arg(mqtt->deliveredCount())
+            .arg(mqtt->duplicateCount())
+            .arg(mqtt->recoveredCount());
+    if (mqtt->isSyncing()) {
+        statusText += tr("状态同步: 进行中\n");
+    } else if (mqtt->lastSyncDurationMs() >= 0) {
+        statusText += tr("状态同步: %1 条消息，耗时 %2 ms\n")
+                .arg(mqtt->lastSyncMessageCount())
+                .arg(mqtt->lastSyncDurationMs());
+    }
+    if (mqtt->isOverloaded() || mqtt->overloadDropCount() > 0) {
+        statusText += tr("入站缓冲: %1积压 %2 条，过载丢弃 %3 条\n")
+                .arg(mqtt->isOverloaded() ? tr("过载中，") : QString())
+                .arg(mqtt->inboundQueueDepth())
+                .arg(mqtt->overloadDropCount());
+    }
     statusText += tr("版本: %1\n").arg(QApplication::applicationVersion());
     statusText += tr("开机自启: %1\n").arg(isAutoStartEnabled() ? tr("已启用") : tr("未启用"));
     
+    // 门状态：摘要加最近发生变化的几扇门，门再多也只排序出需要显示的部分
+    const DoorStateTable &doors = m_clientManager->doorStates();
+    statusText += tr("\n门状态: %1\n").arg(doors.summary());
+    const QList<const DoorStateTable::Door*> recent = doors.recentlyChanged(10);
+    for (const DoorStateTable::Door *door : recent) {
+        statusText += tr("  %1: %2（%3 起，%4 次事件）%5\n")
+                .arg(door->doorId)
+                .arg(DoorStateTable::stateName(door->state))
+                .arg(door->stateSince.toString("MM-dd HH:mm:ss"))
+                .arg(door->eventCount)
+                .arg(door->lastMessage.isEmpty() ? QString() : tr(" 最近消息: %1").arg(door->lastMessage));
+    }
+    if (doors.doorCount() > recent.size()) {
+        statusText += tr("  ……其余 %1 扇门\n").arg(doors.doorCount() - recent.size());
+    }
+    
+    statusText += tr("\n事件延迟:\n%1").arg(m_clientManager->latency().report());
+    
     QMessageBox msgBox;
     msgBox.setWindowTitle(tr("状态信息"));
     msgBox.setText(statusText);
@@ -129,6 +224,81 @@ void SystemTrayManager::onShowStatus()
     msgBox.exec();
 }
 
+void SystemTrayManager::onShowRecentEvents()
+{
+    const int count = 20;
+    QList<EventHistory::Entry> entries = m_clientManager->history().recent(count);
+    showEventList(tr("最近事件"), tr("最近 %1 条事件（最新的在前）:").arg(entries.size()), entries);
+}
+
+void SystemTrayManager::onShowEventsBetween()
+{
+    QDialog dialog;
+    dialog.setWindowTitle(tr("按时间查询事件"));
+    
+    QDateTimeEdit *fromEdit = new QDateTimeEdit(QDateTime::currentDateTime().addSecs(-3600), &dialog);
+    QDateTimeEdit *toEdit = new QDateTimeEdit(QDateTime::currentDateTime(), &dialog);
+    fromEdit->setDisplayFormat("yyyy-MM-dd HH:mm:ss");
+    toEdit->setDisplayFormat("yyyy-MM-dd HH:mm:ss");
+    fromEdit->setCalendarPopup(true);
+    toEdit->setCalendarPopup(true);
+    
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+    connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    
+    QFormLayout *layout = new QFormLayout(&dialog);
+    layout->addRow(tr("开始时间:"), fromEdit);
+    layout->addRow(tr("结束时间:"), toEdit);
+    layout->addRow(buttons);
+    
+    if (dialog.exec() != QDialog::Accepted) {
+        return;
+    }
+    
+    const int limit = 200;
+    QDateTime from = fromEdit->dateTime();
+    QDateTime to = toEdit->dateTime();
+    QList<EventHistory::Entry> entries = m_clientManager->history().between(
+                from.toMSecsSinceEpoch(), to.toMSecsSinceEpoch(), limit);
+    QString header = tr("%1 至 %2 的事件: %3 条")
+            .arg(from.toString("yyyy-MM-dd HH:mm:ss"))
+            .arg(to.toString("yyyy-MM-dd HH:mm:ss"))
+            .arg(entries.size());
+    if (entries.size() >= limit) {
+        header += tr("（只显示前 %1 条）").arg(limit);
+    }
+    showEventList(tr("事件查询"), header + ":", entries);
+}
+
+void SystemTrayManager::showEventList(const QString &title, const QString &header,
+                                      const QList<EventHistory::Entry> &entries)
+{
+    QString text = header + "\n\n";
+    if (!m_clientManager->history().isOpen()) {
+        text += tr("事件历史未启用");
+    } else if (entries.isEmpty()) {
+        text += tr("没有事件");
+    }
+    for (const EventHistory::Entry &entry : entries) {
+        QString line = QDateTime::fromMSecsSinceEpoch(entry.timeMs).toString("MM-dd HH:mm:ss");
+        if (!entry.doorId.isEmpty()) {
+            line += tr("  门 %1").arg(entry.doorId);
+        }
+        line += "  " + (entry.eventType.isEmpty() ? tr("未知事件") : entry.eventType);
+        if (!entry.message.isEmpty()) {
+            line += "  " + entry.message;
+        }
+        text += line + "\n";
+    }
+    
+    QMessageBox msgBox;
+    msgBox.setWindowTitle(title);
+    msgBox.setText(text);
+    msgBox.setIcon(QMessageBox::Information);
+    msgBox.exec();
+}
+
 void SystemTrayManager::onToggleAutoStart()
 {
     bool enable = m_autoStartAction->isChecked();
@@ -138,7 +308,7 @@ void SystemTrayManager::onToggleAutoStart()
 
 void SystemTrayManager::onExit()
 {
-    LOG_INFO("用户通过托盘菜单退出程序");
+    LOG_INFO_CAT(Logger::Ui, "用户通过托盘菜单退出程序");
     
     QMessageBox::StandardButton reply;
     reply = QMessageBox::question(nullptr,
@@ -182,9 +352,9 @@ bool SystemTrayManager::addToStartup()
     
     bool success = (settings.status() == QSettings::NoError);
     if (success) {
-        LOG_INFO(QString("已添加到开机自启动: %1").arg(appPath));
+        LOG_INFO_CAT(Logger::Ui, QString("已添加到开机自启动: %1").arg(appPath));
     } else {
-        LOG_ERROR("添加开机自启动失败");
+        LOG_ERROR_CAT(Logger::Ui, "添加开机自启动失败");
     }
     return success;
 #else
@@ -201,9 +371,9 @@ bool SystemTrayManager::removeFromStartup()
     
     bool success = (settings.status() == QSettings::NoError);
     if (success) {
-        LOG_INFO("已从开机自启动中移除");
+        LOG_INFO_CAT(Logger::Ui, "已从开机自启动中移除");
     } else {
-        LOG_ERROR("移除开机自启动失败");
+        LOG_ERROR_CAT(Logger::Ui, "移除开机自启动失败");
     }
     return success;
 #else
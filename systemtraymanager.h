@@ -5,8 +5,10 @@
 #include <QSystemTrayIcon>
 #include <QMenu>
 #include <QAction>
+#include "eventhistory.h"
 
 class ClientManager;
+class QTimer;
 
 class SystemTrayManager : public QObject
 {
@@ -23,6 +25,8 @@ public:
 private slots:
     void onTrayIconActivated(QSystemTrayIcon::ActivationReason reason);
     void onShowStatus();
+    void onShowRecentEvents();
+    void onShowEventsBetween();
     void onToggleAutoStart();
     void onExit();
     
@@ -31,17 +35,22 @@ private:
     void createActions();
     void createMenu();
     void updateAutoStartAction();
+    void updateToolTip();
     bool addToStartup();
     bool removeFromStartup();
     QString getStartupRegistryPath();
+    void showEventList(const QString &title, const QString &header, const QList<EventHistory::Entry> &entries);
     
     ClientManager *m_clientManager;
     QSystemTrayIcon *m_trayIcon;
     QMenu *m_trayMenu;
     
     QAction *m_statusAction;
+    QAction *m_recentEventsAction;
+    QAction *m_eventsBetweenAction;
     QAction *m_autoStartAction;
     QAction *m_exitAction;
+    QTimer *m_toolTipTimer;  // 门状态变化频繁时合并托盘提示的更新
 };
 
 #endif // SYSTEMTRAYMANAGER_H
@@ -0,0 +1,129 @@
+#include "terminationsignals.h"
+#include <QSocketNotifier>
+
+#ifdef Q_OS_UNIX
+#include <csignal>
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <unistd.h>
+#elif defined(Q_OS_WIN)
+#include <windows.h>
+#include <QMetaObject>
+#endif
+
+#ifdef Q_OS_UNIX
+int TerminationSignals::s_fds[2] = { -1, -1 };
+#elif defined(Q_OS_WIN)
+TerminationSignals *TerminationSignals::s_instance = nullptr;
+#endif
+
+TerminationSignals::TerminationSignals(QObject *parent)
+    : QObject(parent)
+#ifdef Q_OS_UNIX
+    , m_notifier(nullptr)
+#endif
+{
+}
+
+TerminationSignals::~TerminationSignals()
+{
+#ifdef Q_OS_UNIX
+    if (m_notifier) {
+        // 恢复默认处理后再关闭 socketpair，避免信号处理函数写已关闭的描述符
+        std::signal(SIGTERM, SIG_DFL);
+        std::signal(SIGINT, SIG_DFL);
+        std::signal(SIGHUP, SIG_DFL);
+        ::close(s_fds[0]);
+        ::close(s_fds[1]);
+        s_fds[0] = s_fds[1] = -1;
+    }
+#elif defined(Q_OS_WIN)
+    if (s_instance == this) {
+        SetConsoleCtrlHandler(&TerminationSignals::consoleHandler, FALSE);
+        s_instance = nullptr;
+    }
+#endif
+}
+
+bool TerminationSignals::install()
+{
+#ifdef Q_OS_UNIX
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, s_fds) != 0) {
+        return false;
+    }
+    m_notifier = new QSocketNotifier(s_fds[1], QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &TerminationSignals::onSignalReadable);
+    
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = &TerminationSignals::signalHandler;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGTERM, &action, nullptr);
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGHUP, &action, nullptr);
+    return true;
+#elif defined(Q_OS_WIN)
+    s_instance = this;
+    return SetConsoleCtrlHandler(&TerminationSignals::consoleHandler, TRUE) != 0;
+#else
+    return false;
+#endif
+}
+
+void TerminationSignals::onSignalReadable()
+{
+#ifdef Q_OS_UNIX
+    unsigned char signalNumber = 0;
+    if (::read(s_fds[1], &signalNumber, 1) != 1) {
+        return;
+    }
+    emit terminationRequested(QString("收到信号 %1").arg(QString::fromLocal8Bit(strsignal(signalNumber))));
+#endif
+}
+
+#ifdef Q_OS_UNIX
+void TerminationSignals::signalHandler(int signalNumber)
+{
+    // 信号处理函数中只做 async-signal-safe 的 write，保留 errno
+    int savedErrno = errno;
+    unsigned char byte = static_cast<unsigned char>(signalNumber);
+    ssize_t written = ::write(s_fds[0], &byte, 1);
+    Q_UNUSED(written);
+    errno = savedErrno;
+}
+#elif defined(Q_OS_WIN)
+int __stdcall TerminationSignals::consoleHandler(unsigned long ctrlType)
+{
+    // 控制台处理函数在系统创建的线程中运行，转到对象所在线程发出信号
+    TerminationSignals *instance = s_instance;
+    if (!instance) {
+        return FALSE;
+    }
+    QString reason;
+    switch (ctrlType) {
+    case CTRL_C_EVENT:
+        reason = "Ctrl+C";
+        break;
+    case CTRL_BREAK_EVENT:
+        reason = "Ctrl+Break";
+        break;
+    case CTRL_CLOSE_EVENT:
+        reason = "控制台窗口关闭";
+        break;
+    default:
+        reason = "用户注销或系统关机";
+        break;
+    }
+    QMetaObject::invokeMethod(instance, [instance, reason]() {
+        emit instance->terminationRequested(reason);
+    }, Qt::QueuedConnection);
+    
+    // 关闭、注销和关机事件在处理函数返回后进程就会被结束，等主线程完成退出流程
+    if (ctrlType == CTRL_CLOSE_EVENT || ctrlType == CTRL_LOGOFF_EVENT || ctrlType == CTRL_SHUTDOWN_EVENT) {
+        Sleep(5000);
+    }
+    return TRUE;
+}
+#endif
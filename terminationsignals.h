@@ -0,0 +1,39 @@
+#ifndef TERMINATIONSIGNALS_H
+#define TERMINATIONSIGNALS_H
+
+#include <QObject>
+
+class QSocketNotifier;
+
+// 把终止请求（Unix 的 SIGTERM/SIGINT/SIGHUP，Windows 控制台的 Ctrl+C/关闭窗口/注销/关机）
+// 转成 Qt 信号，在事件循环中退出，保证日志刷盘、MQTT 断开和本地套接字清理照常执行
+// Unix 下信号处理函数只往 socketpair 写一个字节（self-pipe），由 QSocketNotifier 在主线程读出
+class TerminationSignals : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TerminationSignals(QObject *parent = nullptr);
+    ~TerminationSignals();
+    
+    // 安装处理函数，进程内只应有一个实例；失败时返回 false
+    bool install();
+
+signals:
+    void terminationRequested(const QString &reason);
+
+private slots:
+    void onSignalReadable();
+
+private:
+#ifdef Q_OS_UNIX
+    static void signalHandler(int signalNumber);
+    static int s_fds[2];
+    QSocketNotifier *m_notifier;
+#elif defined(Q_OS_WIN)
+    static int __stdcall consoleHandler(unsigned long ctrlType);
+    static TerminationSignals *s_instance;
+#endif
+};
+
+#endif // TERMINATIONSIGNALS_H
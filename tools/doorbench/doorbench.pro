@@ -0,0 +1,68 @@
+QT       += core gui widgets network mqtt multimedia
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+# 性能基准工具（不随客户端发布）
+# 解析基准：DoorEvent 快速解析 vs QJsonDocument
+# 流程基准：不连接服务器，通过 MqttClient::injectMessage 把消息送入无界面模式的完整处理流程
+# 回放：把客户端 [Capture] 记录的抓包文件按 1 倍、N 倍或最快速度送入同一流程
+TARGET = doorbench
+
+TEMPLATE = app
+
+# 直接编译主程序中的源文件
+INCLUDEPATH += ../..
+
+SOURCES += \
+    main.cpp \
+    ../../doorevent.cpp \
+    ../../clientmanager.cpp \
+    ../../mqttclient.cpp \
+    ../../notificationwidget.cpp \
+    ../../configmanager.cpp \
+    ../../logger.cpp \
+    ../../eventcoalescer.cpp \
+    ../../notificationmanager.cpp \
+    ../../soundbank.cpp \
+    ../../topicrouter.cpp \
+    ../../reconnectpolicy.cpp \
+    ../../duplicatefilter.cpp \
+    ../../headlessnotifier.cpp \
+    ../../processinfo.cpp \
+    ../../latencyhistogram.cpp \
+    ../../latencymonitor.cpp \
+    ../../metricsserver.cpp \
+    ../../eventhistory.cpp \
+    ../../capturefile.cpp \
+    ../../notificationscheduler.cpp \
+    ../../inboundbuffer.cpp \
+    ../../doorstatetable.cpp
+
+HEADERS += \
+    ../../doorevent.h \
+    ../../clientmanager.h \
+    ../../mqttclient.h \
+    ../../notificationwidget.h \
+    ../../configmanager.h \
+    ../../logger.h \
+    ../../eventcoalescer.h \
+    ../../notificationmanager.h \
+    ../../soundbank.h \
+    ../../topicrouter.h \
+    ../../reconnectpolicy.h \
+    ../../duplicatefilter.h \
+    ../../headlessnotifier.h \
+    ../../processinfo.h \
+    ../../latencyhistogram.h \
+    ../../latencymonitor.h \
+    ../../metricsserver.h \
+    ../../eventhistory.h \
+    ../../capturefile.h \
+    ../../notificationscheduler.h \
+    ../../inboundbuffer.h \
+    ../../doorstatetable.h
+
+win32 {
+    LIBS += -lpsapi
+}
@@ -0,0 +1,479 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QThread>
+#include <QVector>
+#include <QFile>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QDateTime>
+#include <QDir>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "doorevent.h"
+#include "clientmanager.h"
+#include "configmanager.h"
+#include "logger.h"
+#include "processinfo.h"
+#include "capturefile.h"
+
+namespace {
+
+// 统计堆分配次数，用于计算每条事件的分配数
+std::atomic<unsigned long long> g_allocations(0);
+
+} // namespace
+
+void *operator new(std::size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+namespace {
+
+struct PayloadCase
+{
+    QString name;
+    QByteArray payload;
+};
+
+typedef bool (*ParseFunction)(const QByteArray &, DoorEvent *);
+
+// 返回每条消息的平均耗时（纳秒）
+double measure(ParseFunction parse, const QByteArray &payload, int iterations, int *checksum)
+{
+    DoorEvent event;
+    // 预热，避免首次分配影响结果
+    for (int i = 0; i < 1000; ++i) {
+        parse(payload, &event);
+    }
+    
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < iterations; ++i) {
+        if (parse(payload, &event)) {
+            *checksum += event.event.size() + event.message.size();
+        }
+    }
+    return double(timer.nsecsElapsed()) / iterations;
+}
+
+QJsonArray runParseBench(int iterations, QTextStream &out)
+{
+    QVector<PayloadCase> cases;
+    cases.append({ "typical",
+                   "{\"event\":\"door_button_pressed\",\"door_id\":\"A-101\","
+                   "\"timestamp\":\"2025-12-16T08:30:15.123+08:00\"}" });
+    cases.append({ "with_message",
+                   "{\"event\":\"door_button_released\",\"door_id\":12,"
+                   "\"message\":\"\\u4e1c\\u95e8\\u6309\\u94ae\\u5df2\\u677e\\u5f00\","
+                   "\"timestamp\":\"2025-12-16T08:30:15Z\"}" });
+    cases.append({ "extra_fields",
+                   "{\"controller\":{\"id\":\"ctrl-7\",\"fw\":\"2.4.1\",\"slots\":[1,2,3,4]},"
+                   "\"event\":\"door_button_pressed\",\"door_id\":\"B-204\",\"rssi\":-61.5,"
+                   "\"online\":true,\"tags\":[\"lobby\",\"north\"],"
+                   "\"timestamp\":\"2025-12-16T08:30:15.123456\"}" });
+    
+    out << QString("%1 %2 %3 %4\n")
+           .arg("case", -14).arg("fast(ns)", 10).arg("json(ns)", 10).arg("speedup", 8);
+    
+    QJsonArray results;
+    int checksum = 0;
+    for (const PayloadCase &payloadCase : cases) {
+        double fastNs = measure(&DoorEvent::parseFast, payloadCase.payload, iterations, &checksum);
+        double jsonNs = measure(&DoorEvent::parseJson, payloadCase.payload, iterations, &checksum);
+        out << QString("%1 %2 %3 %4x\n")
+               .arg(payloadCase.name, -14)
+               .arg(fastNs, 10, 'f', 1)
+               .arg(jsonNs, 10, 'f', 1)
+               .arg(jsonNs / fastNs, 7, 'f', 2);
+        
+        QJsonObject result;
+        result.insert("case", payloadCase.name);
+        result.insert("fast_ns", fastNs);
+        result.insert("json_ns", jsonNs);
+        results.append(result);
+    }
+    out << QString("checksum: %1\n").arg(checksum);
+    return results;
+}
+
+// 基准专用配置：不合并事件，通知写入日志，关闭监控接口
+bool writeBenchConfig(const QDir &workDir, bool coalesce, const QString &subscribeTopic)
+{
+    QFile file(workDir.filePath("config.ini"));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return false;
+    }
+    QTextStream ini(&file);
+    ini << "[MQTT]\nsubscribe_topic=" << subscribeTopic << "\n"
+        << "[Inbound]\nrate_limit=0\n"
+        << "[Coalesce]\nenabled=" << (coalesce ? "true" : "false") << "\n"
+        << "[Headless]\nsink=log\n"
+        << "[Metrics]\nenabled=false\n"
+        << "[History]\npath=" << workDir.filePath("history/events.ring") << "\n"
+        << "[Log]\npath=" << workDir.filePath("logs") << "\n";
+    return true;
+}
+
+QByteArray makePayload(int sequence, int payloadSize)
+{
+    QByteArray payload = "{\"event\":\"door_button_pressed\",\"door_id\":\"D-"
+            + QByteArray::number(sequence % 50)
+            + "\",\"seq\":" + QByteArray::number(sequence)
+            + ",\"timestamp\":\""
+            + QDateTime::currentDateTime().toString(Qt::ISODateWithMs).toUtf8()
+            + "\",\"message\":\"";
+    // 用 message 字段把负载补足到指定大小
+    int padding = payloadSize - payload.size() - 2;
+    if (padding > 0) {
+        payload.append(QByteArray(padding, 'x'));
+    }
+    payload.append("\"}");
+    return payload;
+}
+
+QJsonObject histogramJson(const LatencyHistogram &histogram)
+{
+    QJsonObject object;
+    object.insert("count", double(histogram.count()));
+    object.insert("p50_us", double(histogram.percentile(50)));
+    object.insert("p99_us", double(histogram.percentile(99)));
+    object.insert("max_us", double(histogram.maxValue()));
+    object.insert("mean_us", histogram.mean());
+    return object;
+}
+
+QJsonObject runPipelineBench(ClientManager &manager, int count, int rate, int payloadSize, QTextStream &out)
+{
+    MqttClient *mqtt = manager.mqtt();
+    const EventCoalescer *coalescer = manager.eventCoalescer();
+    const LatencyMonitor &latency = manager.latency();
+    unsigned long long payloadAllocations = 0;
+    qint64 ingestNs = 0;
+    
+    unsigned long long allocationsBefore = g_allocations.load(std::memory_order_relaxed);
+    QElapsedTimer wall;
+    wall.start();
+    for (int i = 0; i < count; ++i) {
+        // 按目标速率投递；rate 为 0 时尽可能快
+        if (rate > 0) {
+            qint64 dueNs = qint64(i) * 1000000000LL / rate;
+            qint64 waitNs = dueNs - wall.nsecsElapsed();
+            while (waitNs > 0) {
+                QCoreApplication::processEvents();
+                if (waitNs > 2000000) {
+                    QThread::usleep(1000);
+                }
+                waitNs = dueNs - wall.nsecsElapsed();
+            }
+        }
+        
+        // 负载构造的分配不计入处理流程
+        unsigned long long payloadStart = g_allocations.load(std::memory_order_relaxed);
+        QByteArray payload = makePayload(i, payloadSize);
+        QString topic = QString("bench/doors/%1").arg(i % 50);
+        payloadAllocations += g_allocations.load(std::memory_order_relaxed) - payloadStart;
+        
+        // MqttClient 运行在网络线程，和真实消息一样在该线程内完成路由、去重和解析
+        QElapsedTimer ingestTimer;
+        ingestTimer.start();
+        QMetaObject::invokeMethod(mqtt, [mqtt, topic, payload]() {
+            mqtt->injectMessage(topic, payload);
+        }, Qt::BlockingQueuedConnection);
+        ingestNs += ingestTimer.nsecsElapsed();
+        
+        if (rate == 0 && (i & 255) == 0) {
+            QCoreApplication::processEvents();
+        }
+    }
+    
+    // 等待排队到界面线程的事件全部显示完
+    QElapsedTimer drainTimer;
+    drainTimer.start();
+    while (latency.parse().count() < coalescer->emittedCount() && drainTimer.elapsed() < 10000) {
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+    }
+    double seconds = wall.nsecsElapsed() / 1e9;
+    unsigned long long pipelineAllocations = g_allocations.load(std::memory_order_relaxed)
+            - allocationsBefore - payloadAllocations;
+    
+    double messagesPerSecond = count / seconds;
+    double ingestMessagesPerSecond = ingestNs > 0 ? count / (ingestNs / 1e9) : 0.0;
+    double allocationsPerEvent = double(pipelineAllocations) / count;
+    
+    out << QString("pipeline: %1 msgs, payload %2 B, rate %3\n")
+           .arg(count).arg(payloadSize).arg(rate > 0 ? QString("%1/s").arg(rate) : QString("max"));
+    out << QString("  achieved:    %1 msg/s\n").arg(messagesPerSecond, 0, 'f', 0);
+    out << QString("  ingest:      %1 msg/s (%2 us/msg, network thread incl. handoff)\n")
+           .arg(ingestMessagesPerSecond, 0, 'f', 0)
+           .arg(ingestNs / 1000.0 / count, 0, 'f', 2);
+    out << QString("  allocations: %1 per event\n").arg(allocationsPerEvent, 0, 'f', 1);
+    out << QString("  parse:       %1\n").arg(latency.parse().summary());
+    out << QString("  dispatch:    %1\n").arg(latency.dispatch().summary());
+    out << QString("  end-to-end:  %1\n").arg(latency.endToEnd().summary());
+    
+    QJsonObject result;
+    result.insert("messages", count);
+    result.insert("payload_bytes", payloadSize);
+    result.insert("target_rate", rate);
+    result.insert("seconds", seconds);
+    result.insert("messages_per_sec", messagesPerSecond);
+    result.insert("ingest_messages_per_sec", ingestMessagesPerSecond);
+    result.insert("allocations_per_event", allocationsPerEvent);
+    result.insert("parse_failures", double(mqtt->parseFailureCount()));
+    result.insert("overload_drops", double(mqtt->overloadDropCount()));
+    result.insert("log_dropped", double(Logger::instance()->droppedCount()));
+    
+    QJsonObject stages;
+    stages.insert("parse", histogramJson(latency.parse()));
+    stages.insert("dispatch", histogramJson(latency.dispatch()));
+    stages.insert("end_to_end", histogramJson(latency.endToEnd()));
+    result.insert("stages", stages);
+    
+    qint64 rss = ProcessInfo::residentMemoryBytes();
+    if (rss >= 0) {
+        result.insert("resident_memory_bytes", double(rss));
+    }
+    return result;
+}
+
+// 按抓包中的时间间隔回放，speed 为 0 时尽可能快
+QJsonObject runReplay(ClientManager &manager, const QString &capturePath, double speed, int drainMs, QTextStream &out)
+{
+    CaptureReader reader;
+    if (!reader.open(capturePath)) {
+        out << reader.errorString() << "\n";
+        return QJsonObject();
+    }
+    
+    MqttClient *mqtt = manager.mqtt();
+    const EventCoalescer *coalescer = manager.eventCoalescer();
+    const LatencyMonitor &latency = manager.latency();
+    
+    CaptureRecord record;
+    int count = 0;
+    qint64 firstUs = -1;
+    qint64 lastUs = 0;
+    QElapsedTimer wall;
+    wall.start();
+    while (reader.next(&record)) {
+        if (firstUs < 0) {
+            firstUs = record.offsetUs;
+        }
+        lastUs = record.offsetUs;
+        
+        if (speed > 0) {
+            qint64 dueNs = qint64((record.offsetUs - firstUs) * 1000.0 / speed);
+            qint64 waitNs = dueNs - wall.nsecsElapsed();
+            while (waitNs > 0) {
+                QCoreApplication::processEvents();
+                if (waitNs > 2000000) {
+                    QThread::usleep(1000);
+                }
+                waitNs = dueNs - wall.nsecsElapsed();
+            }
+        }
+        
+        QString topic = record.topic;
+        QByteArray payload = record.payload;
+        QMetaObject::invokeMethod(mqtt, [mqtt, topic, payload]() {
+            mqtt->injectMessage(topic, payload);
+        }, Qt::BlockingQueuedConnection);
+        ++count;
+        
+        if ((count & 255) == 0) {
+            QCoreApplication::processEvents();
+        }
+    }
+    if (!reader.errorString().isEmpty()) {
+        out << QString("警告: %1，回放到此为止\n").arg(reader.errorString());
+    }
+    double replaySeconds = wall.nsecsElapsed() / 1e9;
+    
+    // 等待排队到界面线程的事件显示完；突发汇总在突发窗口结束后才发出，需要再等一个窗口
+    QElapsedTimer drainTimer;
+    drainTimer.start();
+    while ((drainTimer.elapsed() < drainMs || latency.parse().count() < coalescer->emittedCount())
+           && drainTimer.elapsed() < drainMs + 10000) {
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+    }
+    
+    double captureSeconds = firstUs >= 0 ? (lastUs - firstUs) / 1e6 : 0.0;
+    quint64 shownEvents = latency.parse().count();
+    quint64 digests = coalescer->digestCount();
+    quint64 dropped = mqtt->duplicateCount() + mqtt->parseFailureCount() + mqtt->overloadDropCount();
+    
+    out << QString("replay: %1 msgs from %2, span %3 s, speed %4\n")
+           .arg(count)
+           .arg(QDateTime::fromMSecsSinceEpoch(reader.startedAtMs()).toString("yyyy-MM-dd HH:mm:ss"))
+           .arg(captureSeconds, 0, 'f', 1)
+           .arg(speed > 0 ? QString("%1x").arg(speed) : QString("max"));
+    out << QString("  replay time: %1 s\n").arg(replaySeconds, 0, 'f', 2);
+    out << QString("  dropped:     %1 (duplicate %2, parse failure %3, overload %4)\n")
+           .arg(dropped).arg(mqtt->duplicateCount()).arg(mqtt->parseFailureCount()).arg(mqtt->overloadDropCount());
+    out << QString("  coalesced:   %1 of %2 events\n").arg(coalescer->coalescedCount()).arg(coalescer->receivedCount());
+    out << QString("  displayed:   %1 (events %2, digests %3)\n").arg(shownEvents + digests).arg(shownEvents).arg(digests);
+    out << QString("  parse:       %1\n").arg(latency.parse().summary());
+    out << QString("  dispatch:    %1\n").arg(latency.dispatch().summary());
+    
+    QJsonObject result;
+    result.insert("capture", capturePath);
+    result.insert("messages", count);
+    result.insert("capture_seconds", captureSeconds);
+    result.insert("replay_seconds", replaySeconds);
+    result.insert("speed", speed);
+    result.insert("received", double(mqtt->receivedCount()));
+    result.insert("dropped", double(dropped));
+    result.insert("duplicates", double(mqtt->duplicateCount()));
+    result.insert("parse_failures", double(mqtt->parseFailureCount()));
+    result.insert("overload_drops", double(mqtt->overloadDropCount()));
+    result.insert("coalesced", double(coalescer->coalescedCount()));
+    result.insert("displayed_events", double(shownEvents));
+    result.insert("digests", double(digests));
+    result.insert("displayed", double(shownEvents + digests));
+    
+    // 抓包中的服务端时间戳早已过去，端到端延迟没有意义，只记录进程内阶段
+    QJsonObject stages;
+    stages.insert("parse", histogramJson(latency.parse()));
+    stages.insert("dispatch", histogramJson(latency.dispatch()));
+    result.insert("stages", stages);
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("doorbench");
+    
+    QCommandLineParser parser;
+    parser.setApplicationDescription("DoorStateClient 性能基准");
+    parser.addHelpOption();
+    QCommandLineOption modeOption("mode", "运行的基准: parse, pipeline, all 或 replay", "mode", "all");
+    QCommandLineOption iterationsOption("iterations", "解析基准每个用例的迭代次数", "n", "200000");
+    QCommandLineOption countOption("count", "流程基准投递的消息数", "n", "20000");
+    QCommandLineOption rateOption("rate", "流程基准每秒投递的消息数，0 表示尽可能快", "n", "0");
+    QCommandLineOption payloadSizeOption("payload-size", "流程基准的负载大小（字节）", "bytes", "160");
+    QCommandLineOption coalesceOption("coalesce", "流程基准中启用事件合并");
+    QCommandLineOption jsonOption("json", "把结果以 JSON 写入文件，- 表示标准输出", "file");
+    QCommandLineOption captureOption("capture", "回放的抓包文件（[Capture] 生成的 .cap）", "file");
+    QCommandLineOption speedOption("speed", "回放速度倍数，max 表示尽可能快", "n|max", "1");
+    parser.addOption(modeOption);
+    parser.addOption(iterationsOption);
+    parser.addOption(countOption);
+    parser.addOption(rateOption);
+    parser.addOption(payloadSizeOption);
+    parser.addOption(coalesceOption);
+    parser.addOption(jsonOption);
+    parser.addOption(captureOption);
+    parser.addOption(speedOption);
+    parser.process(app);
+    
+    QString mode = parser.value(modeOption);
+    bool jsonToStdout = parser.value(jsonOption) == "-";
+    
+    // JSON 输出到标准输出时，文本结果改写到标准错误
+    QTextStream out(jsonToStdout ? stderr : stdout);
+    QJsonObject report;
+    report.insert("timestamp", QDateTime::currentDateTime().toString(Qt::ISODate));
+    
+    if (mode == "parse" || mode == "all") {
+        int iterations = qMax(1, parser.value(iterationsOption).toInt());
+        report.insert("parse", runParseBench(iterations, out));
+    }
+    
+    if (mode == "pipeline" || mode == "all") {
+        QTemporaryDir workDir;
+        if (!workDir.isValid()
+                || !writeBenchConfig(QDir(workDir.path()), parser.isSet(coalesceOption), "bench/doors/+")) {
+            out << "无法创建临时配置\n";
+            return 1;
+        }
+        
+        // 与无界面模式相同的流程：MqttClient -> 合并 -> ClientManager::onDoorEvent -> 日志
+        ConfigManager *config = ConfigManager::instance(workDir.filePath("config.ini"));
+        Logger *logger = Logger::instance();
+        logger->setLogPath(config->getLogPath());
+        logger->setAsyncEnabled(true);
+        
+        {
+            ClientManager manager(true);
+            report.insert("pipeline", runPipelineBench(manager,
+                                                       qMax(1, parser.value(countOption).toInt()),
+                                                       qMax(0, parser.value(rateOption).toInt()),
+                                                       qMax(64, parser.value(payloadSizeOption).toInt()),
+                                                       out));
+        }
+        logger->shutdown();
+    }
+    
+    if (mode == "replay") {
+        if (!parser.isSet(captureOption)) {
+            out << "回放需要 --capture 指定抓包文件\n";
+            return 1;
+        }
+        double speed = 0.0;
+        if (parser.value(speedOption) != "max") {
+            speed = parser.value(speedOption).toDouble();
+            if (speed <= 0.0) {
+                out << QString("无效的回放速度: %1\n").arg(parser.value(speedOption));
+                return 1;
+            }
+        }
+        
+        // 订阅所有主题，抓包中的消息都会进入处理流程
+        QTemporaryDir workDir;
+        if (!workDir.isValid()
+                || !writeBenchConfig(QDir(workDir.path()), parser.isSet(coalesceOption), "#")) {
+            out << "无法创建临时配置\n";
+            return 1;
+        }
+        ConfigManager *config = ConfigManager::instance(workDir.filePath("config.ini"));
+        Logger *logger = Logger::instance();
+        logger->setLogPath(config->getLogPath());
+        logger->setAsyncEnabled(true);
+        
+        int drainMs = parser.isSet(coalesceOption) ? config->snapshot()->coalesceBurstWindow + 500 : 0;
+        QJsonObject result;
+        {
+            ClientManager manager(true);
+            result = runReplay(manager, parser.value(captureOption), speed, drainMs, out);
+        }
+        logger->shutdown();
+        if (result.isEmpty()) {
+            return 1;
+        }
+        report.insert("replay", result);
+    }
+    
+    if (parser.isSet(jsonOption)) {
+        QByteArray json = QJsonDocument(report).toJson();
+        if (jsonToStdout) {
+            QTextStream(stdout) << json;
+        } else {
+            QFile file(parser.value(jsonOption));
+            if (!file.open(QIODevice::WriteOnly)) {
+                out << QString("无法写入 %1\n").arg(parser.value(jsonOption));
+                return 1;
+            }
+            file.write(json);
+        }
+    }
+    
+    return 0;
+}
@@ -0,0 +1,15 @@
+QT       += core
+QT       -= gui
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+# 日志索引与检索工具（不随客户端发布）
+# 为每个 DoorState_*.log 生成 .idx 索引文件（按块记录时间范围、级别、分类和门编号布隆过滤器），
+# 查询时只读取可能命中的块；支持 text 和 jsonl 两种日志格式
+TARGET = logindex
+
+TEMPLATE = app
+
+SOURCES += \
+    main.cpp
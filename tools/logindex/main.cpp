@@ -0,0 +1,513 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QVector>
+#include <limits>
+
+namespace {
+
+const quint32 IndexMagic = 0x44534C49;  // "DSLI"
+const quint32 IndexVersion = 1;
+const int BlockRecords = 256;           // 每块包含的日志条数
+const int HeadBytes = 256;              // 用文件开头的摘要判断日志文件是否被替换
+const int BloomBits = 256;
+const int BloomHashes = 3;
+
+// 级别和分类按位记录，最后一位表示无法识别的值
+enum LevelBit {
+    DebugBit = 0x01,
+    InfoBit = 0x02,
+    WarningBit = 0x04,
+    ErrorBit = 0x08,
+    OtherLevelBit = 0x10
+};
+
+enum CategoryBit {
+    GeneralBit = 0x01,
+    MqttBit = 0x02,
+    UiBit = 0x04,
+    ConfigBit = 0x08,
+    OtherCategoryBit = 0x10
+};
+
+// 一条日志的索引字段；text 格式没有分类和门编号
+struct LogRecord
+{
+    qint64 timeMs;
+    quint8 levelBit;
+    quint8 categoryBit;
+    QString doorId;
+};
+
+struct Block
+{
+    qint64 offset;
+    qint64 length;
+    quint32 records;
+    qint64 minTimeMs;
+    qint64 maxTimeMs;
+    quint8 levelMask;
+    quint8 categoryMask;
+    QByteArray bloom;  // 门编号布隆过滤器
+};
+
+struct Index
+{
+    qint64 indexedBytes;
+    QByteArray headHash;
+    int headLength;
+    QVector<Block> blocks;
+};
+
+struct Query
+{
+    qint64 fromMs;
+    qint64 toMs;
+    quint8 levelMask;
+    quint8 categoryMask;
+    QString doorId;
+};
+
+struct QueryStats
+{
+    int blocksScanned;
+    int blocksSkipped;
+    int linesMatched;
+};
+
+quint8 levelBit(const QString &name)
+{
+    QString upper = name.toUpper();
+    if (upper == "DEBUG") {
+        return DebugBit;
+    } else if (upper == "INFO") {
+        return InfoBit;
+    } else if (upper == "WARNING" || upper == "WARN") {
+        return WarningBit;
+    } else if (upper == "ERROR") {
+        return ErrorBit;
+    }
+    return OtherLevelBit;
+}
+
+quint8 categoryBit(const QString &name)
+{
+    if (name == "general") {
+        return GeneralBit;
+    } else if (name == "mqtt") {
+        return MqttBit;
+    } else if (name == "ui") {
+        return UiBit;
+    } else if (name == "config") {
+        return ConfigBit;
+    }
+    return OtherCategoryBit;
+}
+
+// FNV-1a，不依赖 Qt 版本，索引文件在不同构建之间通用
+quint32 bloomHash(const QByteArray &data, quint32 seed)
+{
+    quint32 hash = 2166136261u ^ seed;
+    for (char c : data) {
+        hash ^= quint8(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+void bloomAdd(QByteArray *bloom, const QString &doorId)
+{
+    QByteArray key = doorId.toUtf8();
+    for (int i = 0; i < BloomHashes; ++i) {
+        quint32 bit = bloomHash(key, quint32(i) * 0x9E3779B9u) % BloomBits;
+        (*bloom)[int(bit / 8)] = char(quint8((*bloom)[int(bit / 8)]) | (1 << (bit % 8)));
+    }
+}
+
+bool bloomMayContain(const QByteArray &bloom, const QString &doorId)
+{
+    QByteArray key = doorId.toUtf8();
+    for (int i = 0; i < BloomHashes; ++i) {
+        quint32 bit = bloomHash(key, quint32(i) * 0x9E3779B9u) % BloomBits;
+        if (!(quint8(bloom.at(int(bit / 8))) & (1 << (bit % 8)))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 解析一行日志；返回 false 表示该行是上一条日志的续行（消息中包含换行）
+bool parseLine(QByteArray line, LogRecord *record)
+{
+    while (line.endsWith('\n') || line.endsWith('\r')) {
+        line.chop(1);
+    }
+    
+    if (line.startsWith('{')) {
+        QJsonObject object = QJsonDocument::fromJson(line).object();
+        if (object.isEmpty() || !object.contains("ts")) {
+            return false;
+        }
+        record->timeMs = qint64(object.value("ts").toDouble());
+        record->levelBit = levelBit(object.value("level").toString());
+        record->categoryBit = categoryBit(object.value("category").toString("general"));
+        record->doorId = object.value("door").toString();
+        return true;
+    }
+    
+    // [yyyy-MM-dd HH:mm:ss] [LEVEL] message
+    if (line.size() < 24 || line.at(0) != '[' || line.at(20) != ']' || line.mid(21, 2) != " [") {
+        return false;
+    }
+    QDateTime time = QDateTime::fromString(QString::fromLatin1(line.mid(1, 19)), "yyyy-MM-dd HH:mm:ss");
+    int levelEnd = line.indexOf(']', 23);
+    if (!time.isValid() || levelEnd < 0) {
+        return false;
+    }
+    record->timeMs = time.toMSecsSinceEpoch();
+    record->levelBit = levelBit(QString::fromLatin1(line.mid(23, levelEnd - 23)));
+    record->categoryBit = OtherCategoryBit;
+    record->doorId.clear();
+    return true;
+}
+
+Block newBlock(qint64 offset)
+{
+    Block block;
+    block.offset = offset;
+    block.length = 0;
+    block.records = 0;
+    block.minTimeMs = std::numeric_limits<qint64>::max();
+    block.maxTimeMs = std::numeric_limits<qint64>::min();
+    block.levelMask = 0;
+    block.categoryMask = 0;
+    block.bloom = QByteArray(BloomBits / 8, '\0');
+    return block;
+}
+
+QDataStream &operator<<(QDataStream &stream, const Block &block)
+{
+    return stream << block.offset << block.length << block.records
+                  << block.minTimeMs << block.maxTimeMs
+                  << block.levelMask << block.categoryMask << block.bloom;
+}
+
+QDataStream &operator>>(QDataStream &stream, Block &block)
+{
+    return stream >> block.offset >> block.length >> block.records
+                  >> block.minTimeMs >> block.maxTimeMs
+                  >> block.levelMask >> block.categoryMask >> block.bloom;
+}
+
+bool loadIndex(const QString &indexPath, Index *index)
+{
+    QFile file(indexPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_6);
+    
+    quint32 magic = 0;
+    quint32 version = 0;
+    qint32 headLength = 0;
+    stream >> magic >> version;
+    if (magic != IndexMagic || version != IndexVersion) {
+        return false;
+    }
+    stream >> index->indexedBytes >> headLength >> index->headHash >> index->blocks;
+    index->headLength = headLength;
+    return stream.status() == QDataStream::Ok;
+}
+
+bool saveIndex(const QString &indexPath, const Index &index)
+{
+    QSaveFile file(indexPath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_6);
+    stream << IndexMagic << IndexVersion
+           << index.indexedBytes << qint32(index.headLength) << index.headHash << index.blocks;
+    return stream.status() == QDataStream::Ok && file.commit();
+}
+
+QByteArray headHash(QFile *file, int length)
+{
+    file->seek(0);
+    return QCryptographicHash::hash(file->read(length), QCryptographicHash::Md5);
+}
+
+// 建立或增量更新索引；日志文件只会追加，已完成的块直接复用，最后一块重新扫描
+bool updateIndex(const QString &logPath, bool rebuild, Index *index, QTextStream &err)
+{
+    QFile file(logPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        err << QString("无法打开日志文件: %1\n").arg(logPath);
+        return false;
+    }
+    qint64 fileSize = file.size();
+    QString indexPath = logPath + ".idx";
+    
+    bool reuse = !rebuild
+            && loadIndex(indexPath, index)
+            && index->indexedBytes <= fileSize
+            && index->headHash == headHash(&file, index->headLength);
+    if (reuse && index->indexedBytes == fileSize) {
+        return true;
+    }
+    
+    qint64 start = 0;
+    if (reuse && !index->blocks.isEmpty()) {
+        // 最后一块可能不完整，或者最后一条日志后来又追加了续行
+        start = index->blocks.last().offset;
+        index->blocks.removeLast();
+    } else if (!reuse) {
+        index->blocks.clear();
+    }
+    
+    file.seek(start);
+    Block block = newBlock(start);
+    bool hasBlock = false;
+    qint64 position = start;
+    LogRecord record;
+    while (!file.atEnd()) {
+        QByteArray line = file.readLine();
+        if (!line.endsWith('\n')) {
+            // 正在写入的半行留到下次索引
+            break;
+        }
+        
+        bool isRecord = parseLine(line, &record);
+        if (isRecord && block.records >= quint32(BlockRecords)) {
+            index->blocks.append(block);
+            block = newBlock(position);
+        }
+        hasBlock = true;
+        block.length += line.size();
+        position += line.size();
+        
+        if (isRecord) {
+            ++block.records;
+            block.minTimeMs = qMin(block.minTimeMs, record.timeMs);
+            block.maxTimeMs = qMax(block.maxTimeMs, record.timeMs);
+            block.levelMask |= record.levelBit;
+            block.categoryMask |= record.categoryBit;
+            if (!record.doorId.isEmpty()) {
+                bloomAdd(&block.bloom, record.doorId);
+            }
+        }
+    }
+    if (hasBlock) {
+        index->blocks.append(block);
+    }
+    
+    index->indexedBytes = position;
+    index->headLength = int(qMin<qint64>(HeadBytes, position));
+    index->headHash = headHash(&file, index->headLength);
+    if (!saveIndex(indexPath, *index)) {
+        err << QString("无法写入索引文件: %1\n").arg(indexPath);
+    }
+    return true;
+}
+
+bool blockMayMatch(const Block &block, const Query &query)
+{
+    return block.records > 0
+            && block.maxTimeMs >= query.fromMs
+            && block.minTimeMs <= query.toMs
+            && (block.levelMask & query.levelMask)
+            && (block.categoryMask & query.categoryMask)
+            && (query.doorId.isEmpty() || bloomMayContain(block.bloom, query.doorId));
+}
+
+bool recordMatches(const LogRecord &record, const Query &query)
+{
+    return record.timeMs >= query.fromMs
+            && record.timeMs <= query.toMs
+            && (record.levelBit & query.levelMask)
+            && (record.categoryBit & query.categoryMask)
+            && (query.doorId.isEmpty() || record.doorId == query.doorId);
+}
+
+void runQuery(const QString &logPath, const Index &index, const Query &query, QFile *output, QueryStats *stats)
+{
+    QFile file(logPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    
+    LogRecord record;
+    for (const Block &block : index.blocks) {
+        if (!blockMayMatch(block, query)) {
+            ++stats->blocksSkipped;
+            continue;
+        }
+        ++stats->blocksScanned;
+        
+        file.seek(block.offset);
+        QByteArray data = file.read(block.length);
+        bool matched = false;
+        int lineStart = 0;
+        while (lineStart < data.size()) {
+            int lineEnd = data.indexOf('\n', lineStart);
+            lineEnd = lineEnd < 0 ? data.size() : lineEnd + 1;
+            QByteArray line = data.mid(lineStart, lineEnd - lineStart);
+            // 续行跟随它所属的日志一起输出
+            if (parseLine(line, &record)) {
+                matched = recordMatches(record, query);
+            }
+            if (matched) {
+                output->write(line);
+                ++stats->linesMatched;
+            }
+            lineStart = lineEnd;
+        }
+    }
+}
+
+bool parseTime(const QString &value, bool endOfDay, qint64 *timeMs)
+{
+    QDateTime time = QDateTime::fromString(value, "yyyy-MM-dd HH:mm:ss");
+    if (!time.isValid()) {
+        time = QDateTime::fromString(value, "yyyy-MM-dd HH:mm");
+    }
+    if (!time.isValid()) {
+        time = QDateTime::fromString(value, Qt::ISODate);
+    }
+    if (!time.isValid()) {
+        QDate date = QDate::fromString(value, "yyyy-MM-dd");
+        if (date.isValid()) {
+            time = endOfDay ? QDateTime(date, QTime(23, 59, 59, 999)) : QDateTime(date, QTime(0, 0));
+        }
+    }
+    if (!time.isValid()) {
+        return false;
+    }
+    *timeMs = time.toMSecsSinceEpoch();
+    return true;
+}
+
+QStringList collectLogFiles(const QStringList &paths)
+{
+    QStringList files;
+    for (const QString &path : paths) {
+        QFileInfo info(path);
+        if (info.isDir()) {
+            QDir dir(path);
+            for (const QString &name : dir.entryList(QStringList() << "DoorState_*.log", QDir::Files, QDir::Name)) {
+                files.append(dir.filePath(name));
+            }
+        } else if (info.isFile()) {
+            files.append(path);
+        }
+    }
+    return files;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("logindex");
+    
+    QCommandLineParser parser;
+    parser.setApplicationDescription("DoorStateClient 日志索引与检索");
+    parser.addHelpOption();
+    parser.addPositionalArgument("paths", "日志文件或日志目录，默认 ./logs", "[paths...]");
+    QCommandLineOption buildOption("build", "只建立/更新索引，不输出日志");
+    QCommandLineOption rebuildOption("rebuild", "忽略已有索引，重新建立");
+    QCommandLineOption fromOption("from", "开始时间，例如 \"2025-12-16 08:00:00\"", "time");
+    QCommandLineOption toOption("to", "结束时间，只写日期时表示当天结束", "time");
+    QCommandLineOption levelOption("level", "最低级别: debug, info, warning, error", "level");
+    QCommandLineOption categoryOption("category", "分类: general, mqtt, ui, config（仅 jsonl 格式）", "category");
+    QCommandLineOption doorOption("door", "门编号（仅 jsonl 格式）", "id");
+    QCommandLineOption statsOption("stats", "在标准错误输出索引命中统计");
+    parser.addOption(buildOption);
+    parser.addOption(rebuildOption);
+    parser.addOption(fromOption);
+    parser.addOption(toOption);
+    parser.addOption(levelOption);
+    parser.addOption(categoryOption);
+    parser.addOption(doorOption);
+    parser.addOption(statsOption);
+    parser.process(app);
+    
+    QTextStream err(stderr);
+    
+    Query query;
+    query.fromMs = std::numeric_limits<qint64>::min();
+    query.toMs = std::numeric_limits<qint64>::max();
+    query.levelMask = 0xFF;
+    query.categoryMask = 0xFF;
+    query.doorId = parser.value(doorOption);
+    
+    if (parser.isSet(fromOption) && !parseTime(parser.value(fromOption), false, &query.fromMs)) {
+        err << QString("无法解析开始时间: %1\n").arg(parser.value(fromOption));
+        return 1;
+    }
+    if (parser.isSet(toOption) && !parseTime(parser.value(toOption), true, &query.toMs)) {
+        err << QString("无法解析结束时间: %1\n").arg(parser.value(toOption));
+        return 1;
+    }
+    if (parser.isSet(levelOption)) {
+        quint8 minimum = levelBit(parser.value(levelOption));
+        if (minimum == OtherLevelBit) {
+            err << QString("未知的日志级别: %1\n").arg(parser.value(levelOption));
+            return 1;
+        }
+        // 不低于指定级别的所有级别
+        query.levelMask = quint8(~(minimum - 1)) & (DebugBit | InfoBit | WarningBit | ErrorBit);
+    }
+    if (parser.isSet(categoryOption)) {
+        query.categoryMask = categoryBit(parser.value(categoryOption).toLower());
+        if (query.categoryMask == OtherCategoryBit) {
+            err << QString("未知的日志分类: %1\n").arg(parser.value(categoryOption));
+            return 1;
+        }
+    }
+    
+    QStringList paths = parser.positionalArguments();
+    if (paths.isEmpty()) {
+        paths << "./logs";
+    }
+    QStringList files = collectLogFiles(paths);
+    if (files.isEmpty()) {
+        err << "没有找到日志文件\n";
+        return 1;
+    }
+    
+    QFile output;
+    output.open(stdout, QIODevice::WriteOnly);
+    
+    for (const QString &logPath : files) {
+        Index index;
+        if (!updateIndex(logPath, parser.isSet(rebuildOption), &index, err)) {
+            continue;
+        }
+        if (parser.isSet(buildOption)) {
+            err << QString("%1: %2 块，%3 字节\n").arg(logPath).arg(index.blocks.size()).arg(index.indexedBytes);
+            continue;
+        }
+        
+        QueryStats stats = { 0, 0, 0 };
+        runQuery(logPath, index, query, &output, &stats);
+        if (parser.isSet(statsOption)) {
+            err << QString("%1: 扫描 %2 块，跳过 %3 块，匹配 %4 行\n")
+                   .arg(logPath).arg(stats.blocksScanned).arg(stats.blocksSkipped).arg(stats.linesMatched);
+        }
+    }
+    output.flush();
+    return 0;
+}
@@ -0,0 +1,177 @@
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+#include <QDateTime>
+#include <QVector>
+#include "notificationwidget.h"
+
+namespace {
+
+const int FadeSteps = 30;  // 500 ms 淡出动画约 30 帧
+
+struct RenderResult
+{
+    QString name;
+    double constructUs;
+    double showUs;
+    double paintUs;
+    double textPaintUs;
+    double fadeFrameUs;
+};
+
+double elapsedUs(const QElapsedTimer &timer, int count)
+{
+    return double(timer.nsecsElapsed()) / 1000.0 / qMax(1, count);
+}
+
+QString messageFor(int i)
+{
+    return QString("门 %1 开门按钮已被按下，请注意查看门口情况（第 %2 次）").arg(i % 8).arg(i);
+}
+
+RenderResult runRenderer(NotificationWidget::Renderer renderer, const QString &name, int iterations)
+{
+    RenderResult result;
+    result.name = name;
+    
+    // 创建：构造窗口并完成一次离屏绘制
+    const int constructCount = qMax(1, iterations / 10);
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < constructCount; ++i) {
+        NotificationWidget widget(renderer);
+        widget.prewarm();
+    }
+    result.constructUs = elapsedUs(timer, constructCount);
+    
+    NotificationWidget widget(renderer);
+    widget.move(0, 0);
+    QImage target(widget.size() * widget.devicePixelRatioF(), QImage::Format_ARGB32_Premultiplied);
+    target.setDevicePixelRatio(widget.devicePixelRatioF());
+    
+    // 显示：窗口被复用时的完整路径，隐藏后设置新文字再显示，处理事件直到绘制完成
+    widget.showNotification("门禁通知 - 预热", messageFor(0), 60000);
+    QCoreApplication::processEvents();
+    timer.restart();
+    for (int i = 0; i < iterations; ++i) {
+        widget.dismiss();
+        widget.showNotification(QString("门禁通知 - %1").arg(i), messageFor(i), 60000);
+        QCoreApplication::processEvents();
+    }
+    result.showUs = elapsedUs(timer, iterations);
+    
+    // 重绘：文字不变，只测 paintEvent
+    timer.restart();
+    for (int i = 0; i < iterations; ++i) {
+        target.fill(Qt::transparent);
+        widget.render(&target);
+    }
+    result.paintUs = elapsedUs(timer, iterations);
+    
+    // 文字变化后重绘：包含重新排版
+    timer.restart();
+    for (int i = 0; i < iterations; ++i) {
+        widget.showNotification(QString("门禁通知 - %1").arg(i), messageFor(i + 1), 60000);
+        target.fill(Qt::transparent);
+        widget.render(&target);
+    }
+    result.textPaintUs = elapsedUs(timer, iterations);
+    
+    // 淡出：与 hideNotification 相同的 windowOpacity 变化，每帧处理一次事件
+    const int fadeRounds = qMax(1, iterations / 20);
+    timer.restart();
+    for (int round = 0; round < fadeRounds; ++round) {
+        for (int step = 1; step <= FadeSteps; ++step) {
+            widget.setWindowOpacity(1.0 - double(step) / FadeSteps);
+            QCoreApplication::processEvents();
+        }
+        widget.setWindowOpacity(1.0);
+    }
+    result.fadeFrameUs = elapsedUs(timer, fadeRounds * FadeSteps);
+    
+    widget.dismiss();
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+    QCoreApplication::setApplicationName("renderbench");
+    
+    QCommandLineParser parser;
+    parser.setApplicationDescription("DoorStateClient 通知窗口渲染基准");
+    parser.addHelpOption();
+    QCommandLineOption iterationsOption("iterations", "每项测量的迭代次数", "n", "500");
+    QCommandLineOption jsonOption("json", "把结果以 JSON 写入文件，- 表示标准输出", "file");
+    parser.addOption(iterationsOption);
+    parser.addOption(jsonOption);
+    parser.process(app);
+    
+    int iterations = qMax(10, parser.value(iterationsOption).toInt());
+    bool jsonToStdout = parser.value(jsonOption) == "-";
+    
+    // JSON 输出到标准输出时，文本结果改写到标准错误
+    QTextStream out(jsonToStdout ? stderr : stdout);
+    
+    QVector<RenderResult> results;
+    results.append(runRenderer(NotificationWidget::StyleSheet, "stylesheet", iterations));
+    results.append(runRenderer(NotificationWidget::Painted, "painted", iterations));
+    
+    out << QString("%1 %2 %3 %4 %5 %6\n")
+           .arg("renderer", -12)
+           .arg("create(us)", 11)
+           .arg("show(us)", 10)
+           .arg("paint(us)", 10)
+           .arg("text+paint", 11)
+           .arg("fade/frame", 11);
+    QJsonArray rows;
+    for (const RenderResult &result : results) {
+        out << QString("%1 %2 %3 %4 %5 %6\n")
+               .arg(result.name, -12)
+               .arg(result.constructUs, 11, 'f', 1)
+               .arg(result.showUs, 10, 'f', 1)
+               .arg(result.paintUs, 10, 'f', 1)
+               .arg(result.textPaintUs, 11, 'f', 1)
+               .arg(result.fadeFrameUs, 11, 'f', 1);
+        
+        QJsonObject row;
+        row.insert("renderer", result.name);
+        row.insert("create_us", result.constructUs);
+        row.insert("show_us", result.showUs);
+        row.insert("paint_us", result.paintUs);
+        row.insert("text_paint_us", result.textPaintUs);
+        row.insert("fade_frame_us", result.fadeFrameUs);
+        rows.append(row);
+    }
+    out << QString("platform: %1, iterations: %2\n").arg(QGuiApplication::platformName()).arg(iterations);
+    out.flush();
+    
+    if (parser.isSet(jsonOption)) {
+        QJsonObject report;
+        report.insert("timestamp", QDateTime::currentDateTime().toString(Qt::ISODate));
+        report.insert("platform", QGuiApplication::platformName());
+        report.insert("iterations", iterations);
+        report.insert("results", rows);
+        QByteArray json = QJsonDocument(report).toJson();
+        if (jsonToStdout) {
+            QTextStream(stdout) << json;
+        } else {
+            QFile file(parser.value(jsonOption));
+            if (!file.open(QIODevice::WriteOnly)) {
+                out << QString("无法写入 %1\n").arg(parser.value(jsonOption));
+                return 1;
+            }
+            file.write(json);
+        }
+    }
+    
+    return 0;
+}
@@ -0,0 +1,21 @@
+QT       += core gui widgets
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+# 通知窗口渲染基准（不随客户端发布）
+# 比较 stylesheet 和 painted 两种 NotificationWidget 的创建、显示、重绘和淡出开销
+# 无显示环境下可以用 QT_QPA_PLATFORM=offscreen 运行
+TARGET = renderbench
+
+TEMPLATE = app
+
+# 直接编译主程序中的源文件
+INCLUDEPATH += ../..
+
+SOURCES += \
+    main.cpp \
+    ../../notificationwidget.cpp
+
+HEADERS += \
+    ../../notificationwidget.h
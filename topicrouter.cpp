@@ -0,0 +1,144 @@
+#include "topicrouter.h"
+#include <QStringList>
+#include <algorithm>
+
+namespace {
+const int MaxCachedTopics = 4096;  // 主题缓存上限，超出后整体清空
+}
+
+TopicRouter::TopicRouter()
+    : m_root(new Node)
+{
+}
+
+TopicRouter::~TopicRouter()
+{
+    deleteNode(m_root);
+}
+
+bool TopicRouter::isValidFilter(const QString &filter)
+{
+    if (filter.isEmpty()) {
+        return false;
+    }
+    
+    // + 必须独占一个层级，# 必须独占最后一个层级
+    const QStringList levels = filter.split('/');
+    for (int i = 0; i < levels.size(); ++i) {
+        const QString &level = levels.at(i);
+        if (level.contains('#') && (level != "#" || i != levels.size() - 1)) {
+            return false;
+        }
+        if (level.contains('+') && level != "+") {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool TopicRouter::addRoute(const QString &filter, int routeId)
+{
+    if (!isValidFilter(filter)) {
+        return false;
+    }
+    
+    Node *node = m_root;
+    const QStringList levels = filter.split('/');
+    for (const QString &level : levels) {
+        Node *&child = node->children[level];
+        if (!child) {
+            child = new Node;
+        }
+        node = child;
+    }
+    
+    if (!node->routes.contains(routeId)) {
+        node->routes.append(routeId);
+    }
+    m_cache.clear();
+    return true;
+}
+
+void TopicRouter::removeRoute(const QString &filter, int routeId)
+{
+    Node *node = m_root;
+    const QStringList levels = filter.split('/');
+    for (const QString &level : levels) {
+        node = node->children.value(level, nullptr);
+        if (!node) {
+            return;
+        }
+    }
+    
+    // 空节点保留，过滤器数量有限，不做回收
+    node->routes.removeAll(routeId);
+    m_cache.clear();
+}
+
+void TopicRouter::clear()
+{
+    deleteNode(m_root);
+    m_root = new Node;
+    m_cache.clear();
+}
+
+QVector<int> TopicRouter::match(const QString &topic)
+{
+    QHash<QString, QVector<int>>::const_iterator cached = m_cache.constFind(topic);
+    if (cached != m_cache.constEnd()) {
+        return cached.value();
+    }
+    
+    QVector<int> routes;
+    matchNode(m_root, topic.split('/'), 0, &routes);
+    std::sort(routes.begin(), routes.end());
+    routes.erase(std::unique(routes.begin(), routes.end()), routes.end());
+    
+    if (m_cache.size() >= MaxCachedTopics) {
+        m_cache.clear();
+    }
+    m_cache.insert(topic, routes);
+    return routes;
+}
+
+void TopicRouter::matchNode(const Node *node, const QStringList &levels, int index, QVector<int> *routes) const
+{
+    // 以 $ 开头的系统主题不匹配首层通配符
+    bool allowWildcards = !(index == 0 && levels.at(0).startsWith('$'));
+    
+    // # 匹配剩余所有层级（包括父层级本身）
+    if (allowWildcards) {
+        const Node *multi = node->children.value("#", nullptr);
+        if (multi) {
+            *routes += multi->routes;
+        }
+    }
+    
+    if (index == levels.size()) {
+        *routes += node->routes;
+        return;
+    }
+    
+    const Node *exact = node->children.value(levels.at(index), nullptr);
+    if (exact) {
+        matchNode(exact, levels, index + 1, routes);
+    }
+    
+    if (allowWildcards) {
+        const Node *single = node->children.value("+", nullptr);
+        if (single) {
+            matchNode(single, levels, index + 1, routes);
+        }
+    }
+}
+
+void TopicRouter::deleteNode(Node *node)
+{
+    if (!node) {
+        return;
+    }
+    for (Node *child : node->children) {
+        deleteNode(child);
+    }
+    delete node;
+}
@@ -0,0 +1,45 @@
+#ifndef TOPICROUTER_H
+#define TOPICROUTER_H
+
+#include <QtGlobal>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QVector>
+
+// MQTT 主题路由表：按层级组织的前缀树，支持 + 和 # 通配符
+// 匹配结果按主题缓存，同一主题的后续消息只需一次哈希查找
+class TopicRouter
+{
+public:
+    TopicRouter();
+    ~TopicRouter();
+    
+    // 添加/移除路由，routeId 由调用方分配
+    bool addRoute(const QString &filter, int routeId);
+    void removeRoute(const QString &filter, int routeId);
+    void clear();
+    
+    // 返回与主题匹配的全部路由，按 routeId 升序且不重复
+    QVector<int> match(const QString &topic);
+    
+    static bool isValidFilter(const QString &filter);
+
+private:
+    // m_root 及其下的节点由本对象负责释放，复制会导致重复释放
+    Q_DISABLE_COPY(TopicRouter)
+    
+    struct Node
+    {
+        QHash<QString, Node*> children;  // 子层级，"+" 和 "#" 也作为普通键保存
+        QVector<int> routes;             // 在此层级结束的过滤器
+    };
+    
+    void matchNode(const Node *node, const QStringList &levels, int index, QVector<int> *routes) const;
+    static void deleteNode(Node *node);
+    
+    Node *m_root;
+    QHash<QString, QVector<int>> m_cache;
+};
+
+#endif // TOPICROUTER_H